@@ -15,6 +15,8 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "mazeRng.h"
+
 /**@brief An enum for keeping track of directions. */
 typedef enum {
     up,   /**@brief The up direction. */
@@ -51,28 +53,6 @@ typedef struct {
     Direction_t dir;
 } Edge_t;
 
-/**@struct Tree_t
- * @brief A structure for Trees.
- *
- * @Var Tree_t::val
- * The value of the current node.
- *
- * @var Tree_t::parent
- * The address of the parent node.
- *
- * @var Tree_t::left
- * The address of the left node.
- *
- * @var Tree_t::right
- * The address of the right node.
- */
-typedef struct Tree_t {
-    int val;
-    struct Tree_t *parent;
-    struct Tree_t *left;
-    struct Tree_t *right;
-} Tree_t;
-
 // clang-format off
 /**@struct Cell_t
  * @brief A structure for Cells.
@@ -108,7 +88,8 @@ typedef struct {
  * The height of the maze.
  *
  * @var Maze_t::str
- * The string representation of the maze.
+ * The cached string representation of the maze, or NULL until
+ * getMazeString() renders it.
  *
  * @var Maze_t:cells
  * The cells of the maze.
@@ -120,6 +101,18 @@ typedef struct {
     Cell_t *cells;
 } Maze_t;
 
+/**@brief Flags changing how a maze is drawn. */
+typedef enum {
+    renderPlain = 0,             /**@brief Draw every flag of the cells. */
+    renderIgnoreVisited = 1 << 0 /**@brief Draw as if no cell was visited. */
+} renderFlags_t;
+
+/**@brief Memory reused between solves (see solverWorkspace.h). */
+struct SolverWorkspace_t;
+
+/**@brief The callbacks watching an algorithm (see stepObserver.h). */
+struct StepObserver_t;
+
 /**@brief The various kinds of generation algorithms. */
 typedef enum {
     kruskal,          /**@brief Kruskal algorithm. */
@@ -147,8 +140,11 @@ typedef enum {
 
 /** @brief Creates a maze from a string
  *
- *  All needed memory is allocated to the maze. This includes space for the
- *  string representation (which will be a carbon copy of the string).
+ *  All needed memory is allocated to the maze. The string representation is
+ *  left NULL; the cells are parsed straight out of str.
+ *
+ *  Every line must be as wide as the first one. If it is not, a message is
+ *  written to stderr and a maze with NULL cells is returned.
  *
  *  @param str The string for creating the maze.
  *  @return The created maze.
@@ -172,7 +168,11 @@ Maze_t createMazeWH(size_t width, size_t height);
  * read. It is assumed the user has done the necessary error checking before
  * calling this function.
  *
+ * Regular files are mapped and parsed in place; other streams are read in
+ * large blocks first. The text is validated as in createMaze().
+ *
  * @param stream The stream to read for importing.
+ * @return The imported maze, with NULL cells if the text was invalid.
  */
 Maze_t importMaze(FILE *stream);
 
@@ -219,6 +219,13 @@ Point_t findStop(Maze_t maze);
  */
 Point_t pointShift(Point_t point, Direction_t direction);
 
+/**@brief Gets the direction that undoes a move.
+ *
+ * @param direction The direction to reverse.
+ * @return The opposite direction.
+ */
+Direction_t oppositeDirection(Direction_t direction);
+
 /**@brief Converts a point to an index.
  *
  * @param point The point to convert.
@@ -260,25 +267,37 @@ double euclidDistance(Point_t p1, Point_t p2);
 uint64_t manhattenDistance(Point_t p1, Point_t p2);
 
 /**@brief Provides a random direction to traverse.
- *
- * Note: This function assumes srand() was called prior to it.
  *
  * @param point The point to travel from.
  * @param maze The maze being traversed.
+ * @param rng The random number generator.
  * @return The direction to traverse.
  */
-Direction_t getRandomDirection(Point_t point, Maze_t maze);
+Direction_t getRandomDirection(Point_t point, Maze_t maze, MazeRng_t *rng);
 
 /**@brief Provides every direction traversable from a point randomly.
  *
- * Note: This function assumes srand() was called prior to it.
+ * The order comes from a single draw out of the 24 orderings of the four
+ * directions, so every order of the traversable directions is equally likely.
  *
  * @param point The point to travel from.
  * @param maze The maze being traversed.
  * @param dir The directions to traverse.
+ * @param rng The random number generator.
  * @return The number of traversable directions.
  */
-size_t getRandomDirections(Point_t point, Maze_t maze, Direction_t dir[4]);
+size_t getRandomDirections(Point_t point, Maze_t maze, Direction_t dir[4],
+                           MazeRng_t *rng);
+
+/**@brief Draws what getRandomDirections() would, without the directions.
+ *
+ * Lets a generator skip a cell that getRandomDirections() was once called on
+ * and still get the same maze for a seed.
+ *
+ * @param rng The random number generator.
+ * @return void
+ */
+void skipRandomDirections(MazeRng_t *rng);
 
 /**@brief Provides every direction from a point.
  *
@@ -298,23 +317,6 @@ size_t getValidDirections(Point_t point, Maze_t maze, Direction_t dir[4]);
  */
 size_t getValidTravelDirections(Point_t point, Maze_t maze, Direction_t dir[4]);
 
-/**@brief Gets the head of the tree.
- *
- * @param tree The tree's head to get.
- * @return The head of the tree.
- */
-Tree_t *getHead(Tree_t *tree);
-
-/**@brief Checks if two trees are the same.
- *
- * Trees are assumed to be the same if their roots are the same key.
- *
- * @param tree1 A tree to check.
- * @param tree2 The other tree to check.
- * @return True if the roots are the same key.
- */
-bool isSameTree(Tree_t *tree1, Tree_t *tree2);
-
 /**@brief Solves a maze recursively.
  *
  * This solver uses a simple depth-first flood-fill algorithm.
@@ -328,21 +330,38 @@ bool isSameTree(Tree_t *tree1, Tree_t *tree2);
 bool solveMaze(Maze_t *maze, Point_t start, Point_t stop,
                solveAlgo_t algorithm);
 
-/**@brief Solves a maze recursively and write the steps.
+/**@brief Solves a maze in a caller supplied workspace.
  *
- * This solver uses a simple depth-first flood-fill algorithm.
- * The function writes all steps taken to solve the maze. Including searching
+ * The workspace is grown to fit the maze if needed. Reusing one workspace for
+ * back-to-back solves avoids allocating and initialising the solver memory
+ * each time.
+ *
+ * @param maze The maze to solve.
+ * @param start The starting location of the solve.
+ * @param stop The stopping location of the solve.
+ * @param algorithm The algorithm to solve the maze.
+ * @param workspace The workspace to solve in.
+ * @return True if the maze was solved.
+ */
+bool solveMazeInWorkspace(Maze_t *maze, Point_t start, Point_t stop,
+                          solveAlgo_t algorithm,
+                          struct SolverWorkspace_t *workspace);
+
+/**@brief Solves a maze and reports the steps.
+ *
+ * The observer sees all steps taken to solve the maze. Including searching
  * and solving.
  *
  * @param maze The maze to solve.
  * @param start The starting location of the solve.
  * @param stop The stopping location of the solve.
- * @param stream The stream for writing.
  * @param algorithm The algorithm to solve the maze.
+ * @param observer The observer of the steps.
  * @return True if the maze was solved.
  */
-bool solveMazeWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                        solveAlgo_t algorithm, FILE *stream);
+bool solveMazeObserved(Maze_t *maze, Point_t start, Point_t stop,
+                       solveAlgo_t algorithm,
+                       const struct StepObserver_t *observer);
 
 /**@brief Converts a grid of cells into a string.
  *
@@ -353,13 +372,106 @@ bool solveMazeWithSteps(Maze_t *maze, Point_t start, Point_t stop,
  */
 char *graphToString(Cell_t *cells, size_t width, size_t height);
 
+/**@brief Gets the size of the string representation of a maze.
+ *
+ * @param width The width of the maze.
+ * @param height The height of the maze.
+ * @return The number of bytes, including the EOS.
+ */
+size_t mazeStringSize(size_t width, size_t height);
+
+/**@brief Renders a maze into a caller supplied buffer.
+ *
+ * Nothing is written unless the buffer can hold the whole string, so the
+ * function can be called with a NULL buffer to size one.
+ *
+ * @param maze The maze to render.
+ * @param buf The buffer to write the EOS terminated string to.
+ * @param sz The size of buf.
+ * @param flags How to draw the cells.
+ * @return The number of bytes needed, including the EOS.
+ */
+size_t renderMaze(const Maze_t *maze, char *buf, size_t sz,
+                  renderFlags_t flags);
+
+/**@brief Redraws one cell of a rendered maze.
+ *
+ * Only the characters of the cell and of the walls around it are written, so
+ * a string rendered by renderMaze() can be kept up to date by patching the
+ * cells that changed since it was drawn.
+ *
+ * @param maze The maze the string was rendered from.
+ * @param str The rendered string to patch.
+ * @param index The index of the cell that changed.
+ * @param flags How to draw the cell, the same as the string was rendered.
+ * @return void
+ */
+void patchMazeString(const Maze_t *maze, char *str, size_t index,
+                     renderFlags_t flags);
+
+/**@brief Renders the border line above the first row of a maze.
+ *
+ * @param row The first row of cells.
+ * @param width The width of the maze.
+ * @param line The buffer for the 2 * width + 2 characters of the line.
+ * @return void
+ */
+void renderMazeTopLine(const Cell_t *row, size_t width, char *line);
+
+/**@brief Renders a row of a maze and the wall line below it.
+ *
+ * Together with renderMazeTopLine() this renders a maze two lines at a time,
+ * so a writer only has to hold two rows of cells.
+ *
+ * @param row The row of cells to render.
+ * @param next The row below it, or NULL for the last row.
+ * @param width The width of the maze.
+ * @param band The buffer for the 2 * (2 * width + 2) characters of the lines.
+ * @return void
+ */
+void renderMazeRowBand(const Cell_t *row, const Cell_t *next, size_t width,
+                       char *band);
+
+/**@brief Writes the string representation of a maze.
+ *
+ * The cached string is used if there is one. Otherwise the maze is rendered
+ * two lines at a time, so only O(width) memory is used and nothing is cached.
+ *
+ * @param stream The stream for writing.
+ * @param maze The maze to write.
+ * @return void
+ */
+void fprintMaze(FILE *restrict stream, const Maze_t *maze);
+
+/**@brief Gets the string representation of a maze.
+ *
+ * The string is rendered on first use and cached in maze->str until the
+ * cells change.
+ *
+ * @param maze The maze to render.
+ * @return The string representation, owned by the maze.
+ */
+const char *getMazeString(Maze_t *maze);
+
+/**@brief Drops the cached string representation of a maze.
+ *
+ * generateMaze, generateMazeObserved and the solvers call this. Code that
+ * changes the cells any other way, such as mazeConnectCells, mazeBreakWall or
+ * a generator called directly, does not, and must call it before the maze is
+ * printed again.
+ *
+ * @param maze The maze to modify.
+ * @return void
+ */
+void invalidateMazeString(Maze_t *maze);
+
 /**@brief Writes the current state of the maze.
  *
  * @param stream The stream for writing.
  * @param maze The maze to write.
  * @return void
  */
-void fprintStep(FILE *restrict stream, Maze_t *maze);
+void fprintStep(FILE *restrict stream, const Maze_t *maze);
 
 /**@brief Writes the current state of the maze while ignoring visited.
  *
@@ -367,7 +479,7 @@ void fprintStep(FILE *restrict stream, Maze_t *maze);
  * @param maze The maze to write.
  * @return void
  */
-void fprintStepIgnoreVisted(FILE *restrict stream, Maze_t *maze);
+void fprintStepIgnoreVisted(FILE *restrict stream, const Maze_t *maze);
 
 /**@brief Frees a maze.
  *
@@ -383,62 +495,59 @@ void freeMaze(Maze_t maze);
  *
  * @param maze The maze to manipulate.
  * @param algorithm The algorithm used for generation.
+ * @param rng The random number generator.
  * @return void
  */
-void generateMaze(Maze_t *maze, genAlgo_t algorithm);
+void generateMaze(Maze_t *maze, genAlgo_t algorithm, MazeRng_t *rng);
 
-/**@brief Generates a maze and writes the steps.
+/**@brief Generates a maze and reports the steps.
  *
  * A maze must be properly defined and allocated for this function.
  * This function works by removing walls until a completed maze is generated.
- * This function will write each time a wall is removed.
+ * The observer sees a step each time a wall is removed.
  *
  * @param maze The maze to manipulate.
  * @param algorithm The algorithm used for generation.
- * @param stream The stream for writing.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  * @return void
  */
-void generateMazeWithSteps(Maze_t *maze, genAlgo_t algorithm,
-                           FILE *restrict stream);
+void generateMazeObserved(Maze_t *maze, genAlgo_t algorithm, MazeRng_t *rng,
+                          const struct StepObserver_t *observer);
 
-/**@brief Removes a node from the tree.
+/**@brief Picks a random start and stop location on opposite borders.
  *
- * The tree's head node will be replaced in the event that the
- * head node is the node desired for removal. If a node is found,
- * the node will be returned after removing.
+ * Every assignRandomStartAndStop*() function draws through this, so they all
+ * pick the same points from the same generator.
  *
- * @param head The head of the tree.
- * @param val The value of the node to remove.
- * @return The removed node.
- */
-Tree_t *removeNode(Tree_t **head, int val);
-
-/**@brief Join two trees together.
- *
- * @param head The main tree to receive the new tree.
- * @param node The tree to merge into the head.
+ * @param width The width of the maze.
+ * @param height The height of the maze.
+ * @param rng The random number generator.
+ * @param start Receives the start.
+ * @param stop Receives the stop.
  * @return void
  */
-void joinTrees(Tree_t *head, Tree_t *node);
+void getRandomStartAndStop(size_t width, size_t height, MazeRng_t *rng,
+                           Point_t *start, Point_t *stop);
 
 /**@brief Assigns a random start and stop location in a maze.
- *
- * Note: This function assumes srand() was called prior to it.
  *
  * @param maze The maze to assign the points.
+ * @param rng The random number generator.
  */
-void assignRandomStartAndStop(Maze_t *maze);
+void assignRandomStartAndStop(Maze_t *maze, MazeRng_t *rng);
 
-/**@brief Assigns a random start and stop location in a maze, and writes it.
+/**@brief Assigns a random start and stop location in a maze, and reports it.
  *
- * Note: Only writes the start step. The stop step is left for the user to
- * determine when to write it.
- * This function assumes srand() was called prior to it.
+ * Note: Only ends a step after the start. The stop is left for the caller to
+ * show in its next step.
  *
  * @param maze The maze to assign the points.
- * @param stream The stream for writing.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void assignRandomStartAndStopWithSteps(Maze_t *maze, FILE *restrict stream);
+void assignRandomStartAndStopObserved(Maze_t *maze, MazeRng_t *rng,
+                                      const struct StepObserver_t *observer);
 
 /**@brief Convert a string to a algorithm.
  *
@@ -13,24 +13,41 @@
 #include <limits.h>
 
 #include "MazeTools.h"
+#include "mazeBits.h"
+#include "solverWorkspace.h"
+#include "stepObserver.h"
 
 /**@brief Solves a maze using A-Star's algorithm.
  *
  * @param maze The maze to solve.
  * @param start The start point of the maze.
  * @param stop The stop point of the maze.
+ * @param workspace The workspace to solve in.
  */
-bool aStarSolve(Maze_t *maze, Point_t start, Point_t stop);
+bool aStarSolve(Maze_t *maze, Point_t start, Point_t stop,
+                SolverWorkspace_t *workspace);
 
-/**@brief Solves a maze using A-Star's algorithm and writes the steps.
+/**@brief Solves a maze using A-Star's algorithm and reports the steps.
  *
  * @param maze The maze to solve.
  * @param start The start point of the maze.
  * @param stop The stop point of the maze.
- * @param stream The stream to write to.
+ * @param workspace The workspace to solve in.
+ * @param observer The observer of the steps.
  */
-bool aStarSolveWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                                FILE *restrict stream);
+bool aStarSolveObserved(Maze_t *maze, Point_t start, Point_t stop,
+                        SolverWorkspace_t *workspace,
+                        const StepObserver_t *observer);
+
+/**@brief Solves a bit-plane maze using A-Star's algorithm.
+ *
+ * @param bits The maze to solve.
+ * @param start The start point of the maze.
+ * @param stop The stop point of the maze.
+ * @param workspace The workspace to solve in.
+ */
+bool aStarSolveBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                    SolverWorkspace_t *workspace);
 
 #endif /* ifndef __A_STAR_H__ */
 
@@ -12,9 +12,11 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
-void aldousBroder(Maze_t *maze);
+void aldousBroder(Maze_t *maze, MazeRng_t *rng);
 
-void aldousBroderWithSteps(Maze_t *maze, FILE *restrict stream);
+void aldousBroderObserved(Maze_t *maze, MazeRng_t *rng,
+                          const StepObserver_t *observer);
 
 #endif /* ifndef __ALDOUS_BRODER_H__ */
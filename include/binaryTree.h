@@ -12,6 +12,8 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "mazeBits.h"
+#include "stepObserver.h"
 
 /**@brief An enum for selecting a binary tree biases. */
 typedef enum {
@@ -25,15 +27,29 @@ typedef enum {
 /**@brief Generates a maze using Binary Tree's algorithm.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
  */
-void binaryTreeGen(Maze_t *maze, binaryTreeBiases_t bias);
+void binaryTreeGen(Maze_t *maze, binaryTreeBiases_t bias, MazeRng_t *rng);
 
-/**@brief Generates a maze using Binary Tree's algorithm and writes the steps.
+/**@brief Generates a maze using Binary Tree's algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void binaryTreeGenWithSteps(Maze_t *maze, binaryTreeBiases_t bias, FILE *restrict stream);
+void binaryTreeGenObserved(Maze_t *maze, binaryTreeBiases_t bias,
+                           MazeRng_t *rng, const StepObserver_t *observer);
+
+/**@brief Generates a bit-plane maze using Binary Tree's algorithm.
+ *
+ * Draws the same random numbers as binaryTreeGen().
+ *
+ * @param bits The maze to generate.
+ * @param bias The direction the tree leans towards.
+ * @param rng The random number generator.
+ */
+void binaryTreeGenBits(MazeBits_t *bits, binaryTreeBiases_t bias,
+                       MazeRng_t *rng);
 
 /**@brief Converts a string to a binary tree bias.
  *
@@ -0,0 +1,131 @@
+/**@file disjointSet.h
+ * @brief Function prototypes for the disjoint-set forest.
+ *
+ * The generators that merge regions of cells (Kruskal, Eller) track which
+ * cells are already connected with this structure. Finds halve the path they
+ * walk and unions hang the smaller set under the larger one, so any sequence
+ * of operations runs in near-linear time.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __DISJOINT_SET_H__
+#define __DISJOINT_SET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**@struct DisjointSet_t
+ * @brief A forest of cell indexes, one tree per set.
+ *
+ * @var DisjointSet_t::parent
+ * The parent of every index; a root is its own parent.
+ *
+ * @var DisjointSet_t::size
+ * The number of indexes in the set of every root. Only roots are kept up to
+ * date.
+ *
+ * @var DisjointSet_t::sz
+ * The number of indexes in the forest.
+ */
+typedef struct {
+    uint32_t *parent;
+    uint32_t *size;
+    size_t sz;
+} DisjointSet_t;
+
+/**@brief Creates a forest where every index is a set of its own.
+ *
+ * @param sz The number of indexes.
+ * @return The created forest.
+ */
+DisjointSet_t createDisjointSet(size_t sz);
+
+/**@brief Makes every index of a forest a set of its own again.
+ *
+ * @param set The forest to reset.
+ * @return void
+ */
+void resetDisjointSet(DisjointSet_t *set);
+
+/**@brief Frees a forest.
+ *
+ * @param set The forest to free.
+ * @return void
+ */
+void freeDisjointSet(DisjointSet_t *set);
+
+/**@brief Finds the root of the set holding an index.
+ *
+ * Every index on the way is pointed at its grandparent.
+ *
+ * @param set The forest to search.
+ * @param i The index to find.
+ * @return The root of the set.
+ */
+static inline uint32_t disjointSetFind(DisjointSet_t *set, uint32_t i) {
+    uint32_t *parent = set->parent;
+
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+
+    return i;
+}
+
+/**@brief Merges the sets holding two indexes.
+ *
+ * @param set The forest to modify.
+ * @param a An index of the first set.
+ * @param b An index of the second set.
+ * @return True if the sets were different, false if they already were one.
+ */
+static inline bool disjointSetUnion(DisjointSet_t *set, uint32_t a,
+                                    uint32_t b) {
+    uint32_t tmp;
+
+    a = disjointSetFind(set, a);
+    b = disjointSetFind(set, b);
+
+    if (a == b) {
+        return false;
+    }
+
+    // hang the smaller tree so no path grows past log2(sz)
+    if (set->size[a] < set->size[b]) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    set->parent[b] = a;
+    set->size[a] += set->size[b];
+
+    return true;
+}
+
+/**@brief Determines if two indexes are in the same set.
+ *
+ * @param set The forest to search.
+ * @param a The first index.
+ * @param b The second index.
+ * @return True if both are in the same set.
+ */
+static inline bool disjointSetSame(DisjointSet_t *set, uint32_t a,
+                                   uint32_t b) {
+    return disjointSetFind(set, a) == disjointSetFind(set, b);
+}
+
+/**@brief Gets the number of indexes in the set holding an index.
+ *
+ * @param set The forest to search.
+ * @param i The index.
+ * @return The size of its set.
+ */
+static inline uint32_t disjointSetSize(DisjointSet_t *set, uint32_t i) {
+    return set->size[disjointSetFind(set, i)];
+}
+
+#endif /* ifndef __DISJOINT_SET_H__ */
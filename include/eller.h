@@ -3,27 +3,65 @@
  *
  * This contains only functions concerned with Eller's algorithm.
  *
+ * Eller's algorithm finishes the maze one row at a time and only needs the
+ * sets of the current row and the one below it, so ellerGenStream() can write
+ * a maze far larger than memory straight to a stream.
+ *
  * @author Blake Wingard (bats23456789@gmail.com)
  * @bug No known bugs.
  */
 #ifndef __ELLER_H__
 #define __ELLER_H__
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
+
+/**@brief An enum for selecting what ellerGenStream() writes. */
+typedef enum {
+    ellerText,  /**@brief The string representation, as fprintMaze(). */
+    ellerBinary /**@brief A .mzb file, as writeMazeFile(). */
+} ellerStreamFormat_t;
 
 /**@brief Generates a maze using Eller's algorithm.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
  */
-void ellerGen(Maze_t *maze);
+void ellerGen(Maze_t *maze, MazeRng_t *rng);
 
-/**@brief Generates a maze using Eller's algorithm and writes the steps.
+/**@brief Generates a maze using Eller's algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
+ */
+void ellerGenObserved(Maze_t *maze, MazeRng_t *rng,
+                      const StepObserver_t *observer);
+
+/**@brief Generates a maze using Eller's algorithm straight into a stream.
+ *
+ * Each row is written as soon as it is finished, so only O(width) memory is
+ * used and each row takes O(width) time however tall the maze is. The walls
+ * are the same as ellerGen() draws from the same generator. The start and
+ * stop are picked up front from a jumped copy of the generator, so they
+ * differ from the ones ellerGen() picks.
+ *
+ * A binary stream must be seekable, since the right and down planes of a
+ * .mzb file are each filled in a row at a time.
+ *
+ * @param stream The stream for writing.
+ * @param width The width of the maze.
+ * @param height The height of the maze.
+ * @param format What to write.
+ * @param rng The random number generator.
+ * @param seed The seed to store in a .mzb header, or 0.
+ * @return True if every byte was written.
  */
-void ellerGenWithSteps(Maze_t *maze, FILE *restrict stream);
+bool ellerGenStream(FILE *stream, size_t width, size_t height,
+                    ellerStreamFormat_t format, MazeRng_t *rng, uint64_t seed);
 
 #endif /* ifndef __ELLER_H__ */
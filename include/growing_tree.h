@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
 /**@brief An enum for selecting a growing tree method. */
 typedef enum {
@@ -39,10 +40,12 @@ typedef enum {
  * @param maze The maze to generate.
  * @param method The method to add new cells.
  * @param split The ratio between dual-methods.
+ * @param rng The random number generator.
  */
-void growingTreeGen(Maze_t *maze, growingTreeMethods_t method, double split);
+void growingTreeGen(Maze_t *maze, growingTreeMethods_t method, double split,
+                    MazeRng_t *rng);
 
-/**@brief Generates a maze using Growing Tree algorithm and writes the steps.
+/**@brief Generates a maze using Growing Tree algorithm and reports the steps.
  *
  * Growing tree is unique amongst the maze generating algorithms.
  * It works by adding cells to a growing tree, and has several methods
@@ -53,10 +56,12 @@ void growingTreeGen(Maze_t *maze, growingTreeMethods_t method, double split);
  * @param maze The maze to generate.
  * @param method The method to add new cells.
  * @param split The ratio between dual-methods.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void growingTreeGenWithSteps(Maze_t *maze, growingTreeMethods_t method,
-                             double split, FILE *restrict stream);
+void growingTreeGenObserved(Maze_t *maze, growingTreeMethods_t method,
+                            double split, MazeRng_t *rng,
+                            const StepObserver_t *observer);
 
 /**@brief Converts a string to a growing tree method.
  *
@@ -12,18 +12,22 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
 /**@brief Generates a maze using Hunt-and-Kill algorithm.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
  */
-void huntAndKillGen(Maze_t *maze);
+void huntAndKillGen(Maze_t *maze, MazeRng_t *rng);
 
-/**@brief Generates a maze using Hunt-and-Kill algorithm and writes the steps.
+/**@brief Generates a maze using Hunt-and-Kill algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void huntAndKillGenWithSteps(Maze_t *maze, FILE *restrict stream);
+void huntAndKillGenObserved(Maze_t *maze, MazeRng_t *rng,
+                            const StepObserver_t *observer);
 
 #endif /* ifndef __HUNT_AND_KILL_H__ */
@@ -0,0 +1,295 @@
+/**@file mazeBits.h
+ * @brief Function prototypes for the packed bit-plane maze layout.
+ *
+ * A MazeBits_t stores every shared wall once. The right wall of a cell is the
+ * left wall of its neighbour, and the bottom wall of a cell is the top wall of
+ * the cell below it, so two bit planes (right and down) hold every inner
+ * wall. The outer top row and left column get their own small border planes.
+ * Search state lives in separate visited, path and queued bitsets.
+ *
+ * Each row of a plane is padded to whole 64-bit words, so a row can be
+ * scanned or cleared a word at a time.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __MAZE_BITS_H__
+#define __MAZE_BITS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MazeTools.h"
+
+/**@struct MazeBits_t
+ * @brief A structure for mazes stored as bit planes.
+ *
+ * @var MazeBits_t::width
+ * The width of the maze.
+ *
+ * @var MazeBits_t::height
+ * The height of the maze.
+ *
+ * @var MazeBits_t::stride
+ * The number of 64-bit words in one row of a plane.
+ *
+ * @var MazeBits_t::right
+ * The walls on the right of each cell.
+ *
+ * @var MazeBits_t::down
+ * The walls below each cell.
+ *
+ * @var MazeBits_t::top
+ * The walls above the top row, one row of bits.
+ *
+ * @var MazeBits_t::left
+ * The walls left of the first column, one bit per row.
+ *
+ * @var MazeBits_t::visited
+ * The cells that have been visited.
+ *
+ * @var MazeBits_t::path
+ * The cells on the path to the solution.
+ *
+ * @var MazeBits_t::queued
+ * The cells that are enqueued.
+ *
+ * @var MazeBits_t::start
+ * The start of the maze, or UINT32_MAX in both coordinates if unassigned.
+ *
+ * @var MazeBits_t::stop
+ * The stop of the maze, or UINT32_MAX in both coordinates if unassigned.
+ *
+ * @var MazeBits_t::mapping
+ * The file mapping the wall planes live in, or NULL if they were allocated.
+ *
+ * @var MazeBits_t::mappingSz
+ * The size of the file mapping.
+ */
+typedef struct {
+    size_t width;
+    size_t height;
+    size_t stride;
+    uint64_t *right;
+    uint64_t *down;
+    uint64_t *top;
+    uint64_t *left;
+    uint64_t *visited;
+    uint64_t *path;
+    uint64_t *queued;
+    Point_t start;
+    Point_t stop;
+    void *mapping;
+    size_t mappingSz;
+} MazeBits_t;
+
+/**@brief Creates a bit-plane maze with every wall in place.
+ *
+ * @param width The width of the maze.
+ * @param height The height of the maze.
+ * @return The created maze.
+ */
+MazeBits_t createMazeBits(size_t width, size_t height);
+
+/**@brief Converts a maze into the bit-plane layout.
+ *
+ * @param maze The maze to convert.
+ * @return The converted maze.
+ */
+MazeBits_t mazeToBits(const Maze_t *maze);
+
+/**@brief Converts a bit-plane maze back into cells.
+ *
+ * The string representation of the returned maze is left NULL.
+ *
+ * @param bits The maze to convert.
+ * @return The converted maze.
+ */
+Maze_t bitsToMaze(const MazeBits_t *bits);
+
+/**@brief Writes the string representation of a bit-plane maze.
+ *
+ * Only two rows are expanded into cells at a time, so the output matches
+ * fprintMaze() on the converted maze while using O(width) memory.
+ *
+ * @param stream The stream for writing.
+ * @param bits The maze to write.
+ * @return void
+ */
+void fprintMazeBits(FILE *restrict stream, const MazeBits_t *bits);
+
+/**@brief Clears the visited, path and queued bitsets of a maze.
+ *
+ * @param bits The maze to clear.
+ * @return void
+ */
+void clearMazeBitsSearch(MazeBits_t *bits);
+
+/**@brief Frees a bit-plane maze.
+ *
+ * @param bits The maze to free.
+ * @return void
+ */
+void freeMazeBits(MazeBits_t *bits);
+
+/**@brief Generates a bit-plane maze.
+ *
+ * The maze must have every wall in place. Only Sidewinder and Binary Tree
+ * carve the planes directly; the other algorithms need a Maze_t and leave the
+ * maze untouched.
+ *
+ * @param bits The maze to manipulate.
+ * @param algorithm The algorithm used for generation.
+ * @param rng The random number generator.
+ * @return True if the algorithm generated the maze.
+ */
+bool generateMazeBits(MazeBits_t *bits, genAlgo_t algorithm, MazeRng_t *rng);
+
+/**@brief Solves a bit-plane maze in a caller supplied workspace.
+ *
+ * @param bits The maze to solve.
+ * @param start The starting location of the solve.
+ * @param stop The stopping location of the solve.
+ * @param algorithm The algorithm to solve the maze.
+ * @param workspace The workspace to solve in.
+ * @return True if the maze was solved.
+ */
+bool solveMazeBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                   solveAlgo_t algorithm, struct SolverWorkspace_t *workspace);
+
+/**@brief Assigns a random start and stop location in a bit-plane maze.
+ *
+ * Draws the same random numbers as assignRandomStartAndStop().
+ *
+ * @param bits The maze to assign the points.
+ * @param rng The random number generator.
+ * @return void
+ */
+void assignRandomStartAndStopBits(MazeBits_t *bits, MazeRng_t *rng);
+
+/**@brief Gets the bit position of a point in a plane.
+ *
+ * @param bits The maze the plane belongs to.
+ * @param point The point to locate.
+ * @return The bit position.
+ */
+static inline size_t mazeBitsPos(const MazeBits_t *bits, Point_t point) {
+    return point.y * bits->stride * 64 + point.x;
+}
+
+/**@brief Tests a bit of a plane.
+ *
+ * @param plane The plane to read.
+ * @param pos The bit position.
+ * @return True if the bit is set.
+ */
+static inline bool bitsTest(const uint64_t *plane, size_t pos) {
+    return (plane[pos >> 6] >> (pos & 63)) & 1;
+}
+
+/**@brief Sets a bit of a plane.
+ *
+ * @param plane The plane to modify.
+ * @param pos The bit position.
+ * @return void
+ */
+static inline void bitsSet(uint64_t *plane, size_t pos) {
+    plane[pos >> 6] |= (uint64_t)1 << (pos & 63);
+}
+
+/**@brief Clears a bit of a plane.
+ *
+ * @param plane The plane to modify.
+ * @param pos The bit position.
+ * @return void
+ */
+static inline void bitsClear(uint64_t *plane, size_t pos) {
+    plane[pos >> 6] &= ~((uint64_t)1 << (pos & 63));
+}
+
+/**@brief Determines if a cell has a wall in a direction.
+ *
+ * @param bits The maze to read.
+ * @param point The cell to check.
+ * @param dir The side of the cell to check.
+ * @return True if the wall is in place.
+ */
+static inline bool mazeBitsHasWall(const MazeBits_t *bits, Point_t point,
+                                   Direction_t dir) {
+    switch (dir) {
+        case up:
+            return point.y == 0
+                       ? bitsTest(bits->top, point.x)
+                       : bitsTest(bits->down,
+                                  mazeBitsPos(bits, point) - bits->stride * 64);
+        case down:
+            return bitsTest(bits->down, mazeBitsPos(bits, point));
+        case left:
+            return point.x == 0 ? bitsTest(bits->left, point.y)
+                                : bitsTest(bits->right, mazeBitsPos(bits, point) - 1);
+        case right:
+        default:
+            return bitsTest(bits->right, mazeBitsPos(bits, point));
+    }
+}
+
+/**@brief Breaks a wall between two cells in a bit-plane maze.
+ *
+ * @param bits The maze to modify.
+ * @param point The location of the cell to break.
+ * @param dir The direction of the wall to break.
+ * @return void
+ */
+static inline void mazeBitsBreakWall(MazeBits_t *bits, Point_t point,
+                                     Direction_t dir) {
+    switch (dir) {
+        case up:
+            bitsClear(bits->down, mazeBitsPos(bits, point) - bits->stride * 64);
+            break;
+        case down:
+            bitsClear(bits->down, mazeBitsPos(bits, point));
+            break;
+        case left:
+            bitsClear(bits->right, mazeBitsPos(bits, point) - 1);
+            break;
+        case right:
+            bitsClear(bits->right, mazeBitsPos(bits, point));
+            break;
+    }
+}
+
+/**@brief Provides every direction traversable from a point.
+ *
+ * Directions come out in the same order as getValidTravelDirections().
+ *
+ * @param point The point to travel from.
+ * @param bits The maze being traversed.
+ * @param dir The directions to traverse.
+ * @return The number of traversable directions.
+ */
+static inline size_t mazeBitsTravelDirections(Point_t point,
+                                              const MazeBits_t *bits,
+                                              Direction_t dir[4]) {
+    size_t dirSz = 0;
+
+    if (point.x > 0 && !mazeBitsHasWall(bits, point, left)) {
+        dir[dirSz++] = left;
+    }
+
+    if (point.x < bits->width - 1 && !mazeBitsHasWall(bits, point, right)) {
+        dir[dirSz++] = right;
+    }
+
+    if (point.y > 0 && !mazeBitsHasWall(bits, point, up)) {
+        dir[dirSz++] = up;
+    }
+
+    if (point.y < bits->height - 1 && !mazeBitsHasWall(bits, point, down)) {
+        dir[dirSz++] = down;
+    }
+
+    return dirSz;
+}
+
+#endif /* ifndef __MAZE_BITS_H__ */
@@ -0,0 +1,95 @@
+/**@file mazeFile.h
+ * @brief Function prototypes for reading and writing .mzb maze files.
+ *
+ * A .mzb file is a MazeFileHeader_t followed by the wall planes of a
+ * MazeBits_t in the order right, down, top, left. Every field is stored in
+ * host byte order, and the header is a multiple of 8 bytes, so a mapped file
+ * can be solved in place without parsing.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __MAZE_FILE_H__
+#define __MAZE_FILE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "mazeBits.h"
+
+/**@brief The magic bytes at the start of every .mzb file. */
+#define MAZE_FILE_MAGIC "MZB1"
+
+/**@brief Written in host order so a mismatched reader can reject the file. */
+#define MAZE_FILE_BYTE_ORDER 0x01020304u
+
+/**@struct MazeFileHeader_t
+ * @brief The header of a .mzb file.
+ *
+ * @var MazeFileHeader_t::magic
+ * Always MAZE_FILE_MAGIC.
+ *
+ * @var MazeFileHeader_t::byteOrder
+ * Always MAZE_FILE_BYTE_ORDER as the writer saw it.
+ *
+ * @var MazeFileHeader_t::width
+ * The width of the maze.
+ *
+ * @var MazeFileHeader_t::height
+ * The height of the maze.
+ *
+ * @var MazeFileHeader_t::start
+ * The start of the maze.
+ *
+ * @var MazeFileHeader_t::stop
+ * The stop of the maze.
+ *
+ * @var MazeFileHeader_t::seed
+ * The seed the maze was generated with, or 0 if it is unknown.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t byteOrder;
+    uint64_t width;
+    uint64_t height;
+    Point_t start;
+    Point_t stop;
+    uint64_t seed;
+} MazeFileHeader_t;
+
+/**@brief Determines if a path names a .mzb file.
+ *
+ * @param path The path to check.
+ * @return True if the path ends in ".mzb".
+ */
+bool isMazeFilePath(const char *path);
+
+/**@brief Writes a maze as a .mzb file.
+ *
+ * Only the walls, start, stop and seed are written; search state is not.
+ *
+ * @param stream The stream for writing.
+ * @param bits The maze to write.
+ * @param seed The seed the maze was generated with, or 0.
+ * @return True if every byte was written.
+ */
+bool writeMazeFile(FILE *stream, const MazeBits_t *bits, uint64_t seed);
+
+/**@brief Maps a .mzb file into a maze.
+ *
+ * The wall planes point straight into a private mapping of the file, so
+ * nothing is parsed or copied and pages are read as the solver touches them.
+ * Changes to the walls stay private to the process. The search bitsets are
+ * allocated zeroed. The maze must be released with freeMazeBits().
+ *
+ * On failure errno describes the problem and bits is left untouched.
+ *
+ * @param path The file to map.
+ * @param bits The maze to fill in.
+ * @param seed Receives the seed stored in the file. May be NULL.
+ * @return True if the file was mapped.
+ */
+bool loadMazeFile(const char *path, MazeBits_t *bits, uint64_t *seed);
+
+#endif /* ifndef __MAZE_FILE_H__ */
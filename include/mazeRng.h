@@ -0,0 +1,112 @@
+/**@file mazeRng.h
+ * @brief Function prototypes for the maze random number generator.
+ *
+ * MazeRng_t is a xoshiro256** generator. It is much faster than rand(), gives
+ * 64 bits per call, and mazeRngBelow() draws an index without the bias of
+ * rand() % n. Every generator draws from a MazeRng_t passed in by the caller,
+ * so a maze is reproduced by its seed and generators share no global state.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __MAZE_RNG_H__
+#define __MAZE_RNG_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**@struct MazeRng_t
+ * @brief The state of a random number generator.
+ *
+ * @var MazeRng_t::s
+ * The xoshiro256** state. It is never all zero.
+ */
+typedef struct {
+    uint64_t s[4];
+} MazeRng_t;
+
+/**@brief Creates a generator from a seed.
+ *
+ * The seed is spread over the state with splitmix64, so nearby seeds give
+ * unrelated sequences.
+ *
+ * @param seed The seed.
+ * @return The created generator.
+ */
+MazeRng_t createMazeRng(uint64_t seed);
+
+/**@brief Advances a generator by 2^128 draws.
+ *
+ * A copy of a generator that is jumped gives a stream that will not overlap
+ * the original, for draws that must not disturb it.
+ *
+ * @param rng The generator to advance.
+ * @return void
+ */
+void mazeRngJump(MazeRng_t *rng);
+
+/**@brief Draws 64 random bits.
+ *
+ * @param rng The generator.
+ * @return The random value.
+ */
+static inline uint64_t mazeRngNext(MazeRng_t *rng) {
+    uint64_t *s = rng->s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    return result;
+}
+
+/**@brief Draws a uniform value in [0, bound).
+ *
+ * Uses Lemire's multiply-shift, which only divides when a draw lands in the
+ * small biased range.
+ *
+ * @param rng The generator.
+ * @param bound The exclusive upper bound, greater than 0.
+ * @return The random value.
+ */
+static inline uint32_t mazeRngBelow(MazeRng_t *rng, uint32_t bound) {
+    uint64_t m = (mazeRngNext(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)m;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+
+        while (low < threshold) {
+            m = (mazeRngNext(rng) >> 32) * bound;
+            low = (uint32_t)m;
+        }
+    }
+
+    return m >> 32;
+}
+
+/**@brief Flips a coin.
+ *
+ * @param rng The generator.
+ * @return True or false, with equal odds.
+ */
+static inline bool mazeRngCoin(MazeRng_t *rng) {
+    return mazeRngNext(rng) >> 63;
+}
+
+/**@brief Draws a uniform value in [0, 1).
+ *
+ * @param rng The generator.
+ * @return The random value, a multiple of 2^-53.
+ */
+static inline double mazeRngUnit(MazeRng_t *rng) {
+    return (mazeRngNext(rng) >> 11) * 0x1.0p-53;
+}
+
+#endif /* ifndef __MAZE_RNG_H__ */
@@ -0,0 +1,145 @@
+/**@file packedDirections.h
+ * @brief Function prototypes for packed direction storage.
+ *
+ * A Direction_t only needs 2 bits, so these containers store four directions
+ * per byte.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __PACKED_DIRECTIONS_H__
+#define __PACKED_DIRECTIONS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MazeTools.h"
+
+/**@struct DirectionStack_t
+ * @brief A growable stack of directions packed 2 bits per entry.
+ *
+ * @var DirectionStack_t::bits
+ * The packed directions.
+ *
+ * @var DirectionStack_t::count
+ * The number of directions on the stack.
+ *
+ * @var DirectionStack_t::sz
+ * The number of directions the stack can hold before growing.
+ */
+typedef struct {
+    uint8_t *bits;
+    size_t count;
+    size_t sz;
+} DirectionStack_t;
+
+/**@struct DirectionMap_t
+ * @brief A fixed size array of directions packed 2 bits per cell.
+ *
+ * @var DirectionMap_t::bits
+ * The packed directions.
+ *
+ * @var DirectionMap_t::sz
+ * The number of cells in the map.
+ */
+typedef struct {
+    uint8_t *bits;
+    size_t sz;
+} DirectionMap_t;
+
+/**@brief Creates a direction stack.
+ *
+ * @param sz The initial number of directions the stack can hold.
+ * @return The created stack.
+ */
+DirectionStack_t createDirectionStack(size_t sz);
+
+/**@brief Grows a direction stack so it can hold at least one more entry.
+ *
+ * @param stack The stack to grow.
+ * @return void
+ */
+void growDirectionStack(DirectionStack_t *stack);
+
+/**@brief Frees a direction stack.
+ *
+ * @param stack The stack to free.
+ * @return void
+ */
+void freeDirectionStack(DirectionStack_t *stack);
+
+/**@brief Creates a direction map.
+ *
+ * The entries start out uninitialized.
+ *
+ * @param sz The number of cells in the map.
+ * @return The created map.
+ */
+DirectionMap_t createDirectionMap(size_t sz);
+
+/**@brief Frees a direction map.
+ *
+ * @param map The map to free.
+ * @return void
+ */
+void freeDirectionMap(DirectionMap_t *map);
+
+/**@brief Pushes a direction onto a stack.
+ *
+ * @param stack The stack to modify.
+ * @param dir The direction to push.
+ * @return void
+ */
+static inline void directionStackPush(DirectionStack_t *stack,
+                                      Direction_t dir) {
+    size_t i = stack->count++;
+    unsigned shift = (i & 3) * 2;
+
+    if (i == stack->sz) {
+        growDirectionStack(stack);
+    }
+
+    stack->bits[i >> 2] =
+        (stack->bits[i >> 2] & ~(3u << shift)) | ((unsigned)dir << shift);
+}
+
+/**@brief Pops a direction off a stack.
+ *
+ * The stack must not be empty.
+ *
+ * @param stack The stack to modify.
+ * @return The popped direction.
+ */
+static inline Direction_t directionStackPop(DirectionStack_t *stack) {
+    size_t i = --stack->count;
+
+    return (Direction_t)((stack->bits[i >> 2] >> ((i & 3) * 2)) & 3);
+}
+
+/**@brief Sets the direction of a cell in a map.
+ *
+ * @param map The map to modify.
+ * @param i The index of the cell.
+ * @param dir The direction to store.
+ * @return void
+ */
+static inline void directionMapSet(DirectionMap_t *map, size_t i,
+                                   Direction_t dir) {
+    unsigned shift = (i & 3) * 2;
+
+    map->bits[i >> 2] =
+        (map->bits[i >> 2] & ~(3u << shift)) | ((unsigned)dir << shift);
+}
+
+/**@brief Gets the direction of a cell in a map.
+ *
+ * @param map The map to read.
+ * @param i The index of the cell.
+ * @return The stored direction.
+ */
+static inline Direction_t directionMapGet(const DirectionMap_t *map,
+                                          size_t i) {
+    return (Direction_t)((map->bits[i >> 2] >> ((i & 3) * 2)) & 3);
+}
+
+#endif /* ifndef __PACKED_DIRECTIONS_H__ */
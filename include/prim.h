@@ -12,18 +12,22 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
 /**@brief Generates a maze using Prim's algorithm.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
  */
-void primGen(Maze_t *maze);
+void primGen(Maze_t *maze, MazeRng_t *rng);
 
-/**@brief Generates a maze using Prim's algorithm and writes the steps.
+/**@brief Generates a maze using Prim's algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void primGenWithSteps(Maze_t *maze, FILE *restrict stream);
+void primGenObserved(Maze_t *maze, MazeRng_t *rng,
+                     const StepObserver_t *observer);
 
 #endif /* ifndef __PRIM_H__ */
@@ -0,0 +1,267 @@
+/**@file priorityQueue.h
+ * @brief Function prototypes for the solver queues.
+ *
+ * This contains a growable ring buffer, an indexed binary heap (with
+ * decrease-key) and a monotone bucket queue. All queues store cell indexes,
+ * and the priority queues break ties between equal keys in
+ * first-in-first-out order so solvers expand cells in the same order
+ * regardless of which queue backs them.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __PRIORITY_QUEUE_H__
+#define __PRIORITY_QUEUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**@brief The value used to mark an index that is not in a queue. */
+#define QUEUE_INVALID_INDEX UINT32_MAX
+
+/**@struct RingQueue_t
+ * @brief A growable circular FIFO of cell indexes.
+ *
+ * @var RingQueue_t::indexes
+ * The stored cell indexes.
+ *
+ * @var RingQueue_t::head
+ * The position of the next index to pop.
+ *
+ * @var RingQueue_t::count
+ * The number of indexes in the queue.
+ *
+ * @var RingQueue_t::sz
+ * The allocated size of indexes (always a power of two).
+ */
+typedef struct {
+    uint32_t *indexes;
+    size_t head;
+    size_t count;
+    size_t sz;
+} RingQueue_t;
+
+/**@struct HeapNode_t
+ * @brief A structure for the entries of an indexed heap.
+ *
+ * @var HeapNode_t::key
+ * The priority of the entry (lower is served first).
+ *
+ * @var HeapNode_t::seq
+ * The insertion order of the entry, used to break ties.
+ *
+ * @var HeapNode_t::index
+ * The cell index stored in the entry.
+ */
+typedef struct {
+    uint64_t key;
+    uint32_t seq;
+    uint32_t index;
+} HeapNode_t;
+
+/**@struct IndexedHeap_t
+ * @brief A binary min-heap of cell indexes that supports decrease-key.
+ *
+ * @var IndexedHeap_t::nodes
+ * The heap ordered entries.
+ *
+ * @var IndexedHeap_t::pos
+ * One past the position of every cell index inside nodes, or 0 if the index
+ * is not queued.
+ *
+ * @var IndexedHeap_t::count
+ * The number of entries in the heap.
+ *
+ * @var IndexedHeap_t::nodeSz
+ * The allocated size of nodes, which grows with the frontier.
+ *
+ * @var IndexedHeap_t::sz
+ * The number of cell indexes the heap can hold.
+ *
+ * @var IndexedHeap_t::seq
+ * The next insertion sequence number.
+ */
+typedef struct {
+    HeapNode_t *nodes;
+    uint32_t *pos;
+    size_t count;
+    size_t nodeSz;
+    size_t sz;
+    uint32_t seq;
+} IndexedHeap_t;
+
+/**@struct Bucket_t
+ * @brief A FIFO of cell indexes that share a key.
+ *
+ * @var Bucket_t::indexes
+ * The stored cell indexes.
+ *
+ * @var Bucket_t::head
+ * The position of the next index to pop.
+ *
+ * @var Bucket_t::count
+ * The number of indexes pushed since the bucket was last emptied.
+ *
+ * @var Bucket_t::sz
+ * The allocated size of indexes.
+ */
+typedef struct {
+    uint32_t *indexes;
+    size_t head;
+    size_t count;
+    size_t sz;
+} Bucket_t;
+
+/**@struct BucketQueue_t
+ * @brief A monotone bucket queue for small integer keys.
+ *
+ * Every key pushed must be no smaller than the last key popped, and no larger
+ * than the last key popped plus maxStep. Decrease-key is handled lazily: an
+ * index pushed again with a smaller key leaves the old entry behind, and the
+ * caller skips it with its closed set.
+ *
+ * @var BucketQueue_t::buckets
+ * A ring of maxStep + 1 buckets.
+ *
+ * @var BucketQueue_t::bucketCount
+ * The number of buckets in the ring.
+ *
+ * @var BucketQueue_t::key
+ * The key of the bucket currently being served.
+ *
+ * @var BucketQueue_t::count
+ * The number of indexes in all buckets.
+ */
+typedef struct {
+    Bucket_t *buckets;
+    size_t bucketCount;
+    uint64_t key;
+    size_t count;
+} BucketQueue_t;
+
+/**@brief Creates a ring queue.
+ *
+ * @param sz The initial number of indexes the queue can hold.
+ * @return The created queue.
+ */
+RingQueue_t createRingQueue(size_t sz);
+
+/**@brief Pushes an index onto the back of a ring queue.
+ *
+ * The queue doubles in size when it is full.
+ *
+ * @param queue The queue to modify.
+ * @param index The cell index to push.
+ * @return void
+ */
+void ringQueuePush(RingQueue_t *queue, uint32_t index);
+
+/**@brief Pops the index at the front of a ring queue.
+ *
+ * @param queue The queue to modify.
+ * @return The popped index, or QUEUE_INVALID_INDEX if the queue is empty.
+ */
+uint32_t ringQueuePop(RingQueue_t *queue);
+
+/**@brief Removes every entry from a ring queue.
+ *
+ * @param queue The queue to clear.
+ * @return void
+ */
+void clearRingQueue(RingQueue_t *queue);
+
+/**@brief Frees a ring queue.
+ *
+ * @param queue The queue to free.
+ * @return void
+ */
+void freeRingQueue(RingQueue_t *queue);
+
+/**@brief Creates an indexed heap for cell indexes less than sz.
+ *
+ * @param sz The number of cell indexes.
+ * @return The created heap.
+ */
+IndexedHeap_t createIndexedHeap(size_t sz);
+
+/**@brief Pushes an index, or lowers its key if it is already queued.
+ *
+ * A key that is not lower than the queued key leaves the heap untouched.
+ *
+ * @param heap The heap to modify.
+ * @param index The cell index to push.
+ * @param key The priority of the index.
+ * @return True if the heap was modified.
+ */
+bool indexedHeapPush(IndexedHeap_t *heap, uint32_t index, uint64_t key);
+
+/**@brief Pops the index with the lowest key.
+ *
+ * @param heap The heap to modify.
+ * @param key The key of the popped index (may be NULL).
+ * @return The popped index, or QUEUE_INVALID_INDEX if the heap is empty.
+ */
+uint32_t indexedHeapPop(IndexedHeap_t *heap, uint64_t *key);
+
+/**@brief Checks if an index is in the heap.
+ *
+ * @param heap The heap to check.
+ * @param index The cell index to check.
+ * @return True if the index is queued.
+ */
+bool indexedHeapContains(const IndexedHeap_t *heap, uint32_t index);
+
+/**@brief Removes every entry from the heap.
+ *
+ * @param heap The heap to clear.
+ * @return void
+ */
+void clearIndexedHeap(IndexedHeap_t *heap);
+
+/**@brief Frees an indexed heap.
+ *
+ * @param heap The heap to free.
+ * @return void
+ */
+void freeIndexedHeap(IndexedHeap_t *heap);
+
+/**@brief Creates a bucket queue.
+ *
+ * @param maxStep The largest difference between a pushed and a popped key.
+ * @return The created queue.
+ */
+BucketQueue_t createBucketQueue(size_t maxStep);
+
+/**@brief Pushes an index into a bucket queue.
+ *
+ * @param queue The queue to modify.
+ * @param index The cell index to push.
+ * @param key The priority of the index.
+ * @return void
+ */
+void bucketQueuePush(BucketQueue_t *queue, uint32_t index, uint64_t key);
+
+/**@brief Pops the index with the lowest key.
+ *
+ * @param queue The queue to modify.
+ * @param key The key of the popped index (may be NULL).
+ * @return The popped index, or QUEUE_INVALID_INDEX if the queue is empty.
+ */
+uint32_t bucketQueuePop(BucketQueue_t *queue, uint64_t *key);
+
+/**@brief Removes every entry from a bucket queue.
+ *
+ * @param queue The queue to clear.
+ * @return void
+ */
+void clearBucketQueue(BucketQueue_t *queue);
+
+/**@brief Frees a bucket queue.
+ *
+ * @param queue The queue to free.
+ * @return void
+ */
+void freeBucketQueue(BucketQueue_t *queue);
+
+#endif /* ifndef __PRIORITY_QUEUE_H__ */
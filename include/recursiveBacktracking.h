@@ -12,9 +12,11 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
-void recursiveBacktracking(Maze_t *maze);
+void recursiveBacktracking(Maze_t *maze, MazeRng_t *rng);
 
-void recursiveBacktrackingWithSteps(Maze_t *maze, FILE *restrict stream);
+void recursiveBacktrackingObserved(Maze_t *maze, MazeRng_t *rng,
+                                   const StepObserver_t *observer);
 
 #endif /* ifndef __RECURSIVE_BACKTRACKING_H__ */
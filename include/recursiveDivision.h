@@ -12,18 +12,35 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "stepObserver.h"
 
 /**@brief Generates a maze using Recursive Division's algorithm.
+ *
+ * Large mazes are divided by one thread per online processor. The maze for a
+ * seed does not depend on the number of threads.
+ *
+ * @param maze The maze to generate.
+ * @param rng The random number generator.
+ */
+void recursiveDivisionGen(Maze_t *maze, MazeRng_t *rng);
+
+/**@brief Generates a maze using Recursive Division's algorithm with a given
+ * number of threads.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
+ * @param threads The number of threads to divide with, at least 1.
  */
-void recursiveDivisionGen(Maze_t *maze);
+void recursiveDivisionGenThreads(Maze_t *maze, MazeRng_t *rng,
+                                 size_t threads);
 
-/**@brief Generates a maze using Recursive Division's algorithm and writes the steps.
+/**@brief Generates a maze using Recursive Division's algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void recursiveDivisionGenWithSteps(Maze_t *maze, FILE *restrict stream);
+void recursiveDivisionGenObserved(Maze_t *maze, MazeRng_t *rng,
+                                  const StepObserver_t *observer);
 
 #endif /* ifndef __RECURSIVE_DIVISION_H__ */
@@ -12,18 +12,32 @@
 #include <stdio.h>
 
 #include "MazeTools.h"
+#include "mazeBits.h"
+#include "stepObserver.h"
 
 /**@brief Generates a maze using Sidewinder's algorithm.
  *
  * @param maze The maze to generate.
+ * @param rng The random number generator.
  */
-void sidewinderGen(Maze_t *maze);
+void sidewinderGen(Maze_t *maze, MazeRng_t *rng);
 
-/**@brief Generates a maze using Sidewinder's algorithm and writes the steps.
+/**@brief Generates a maze using Sidewinder's algorithm and reports the steps.
  *
  * @param maze The maze to generate.
- * @param stream The stream to write to.
+ * @param rng The random number generator.
+ * @param observer The observer of the steps.
  */
-void sidewinderGenWithSteps(Maze_t *maze, FILE *restrict stream);
+void sidewinderGenObserved(Maze_t *maze, MazeRng_t *rng,
+                           const StepObserver_t *observer);
+
+/**@brief Generates a bit-plane maze using Sidewinder's algorithm.
+ *
+ * Draws the same random numbers as sidewinderGen().
+ *
+ * @param bits The maze to generate.
+ * @param rng The random number generator.
+ */
+void sidewinderGenBits(MazeBits_t *bits, MazeRng_t *rng);
 
 #endif /* ifndef __SIDEWINDER_H__ */
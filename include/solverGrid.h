@@ -0,0 +1,243 @@
+/**@file solverGrid.h
+ * @brief The cell accessors the solvers work through.
+ *
+ * Every solver has a single implementation that reads and marks cells through
+ * a SolverGrid_t, so it runs on both a Maze_t and a MazeBits_t. The entry
+ * points build the grid with a constant layout, and since the implementation
+ * is forced inline into each of them the layout checks below fold away, the
+ * same way a NULL observer does.
+ *
+ * A cell is addressed by its position in the layout, from gridPos(). It is
+ * the cell index in a Maze_t and the bit position in a MazeBits_t.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __SOLVER_GRID_H__
+#define __SOLVER_GRID_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "MazeTools.h"
+#include "mazeBits.h"
+
+/**@struct SolverGrid_t
+ * @brief A structure for the maze a solver works on.
+ *
+ * @var SolverGrid_t::packed
+ * True if the maze is a MazeBits_t.
+ *
+ * @var SolverGrid_t::maze
+ * The maze, or NULL if it is packed.
+ *
+ * @var SolverGrid_t::bits
+ * The packed maze, or NULL if it is not packed.
+ *
+ * @var SolverGrid_t::width
+ * The width of the maze.
+ *
+ * @var SolverGrid_t::height
+ * The height of the maze.
+ */
+typedef struct {
+    bool packed;
+    Maze_t *maze;
+    MazeBits_t *bits;
+    size_t width;
+    size_t height;
+} SolverGrid_t;
+
+/**@brief Creates a grid over a maze.
+ *
+ * @param maze The maze to solve.
+ * @return The created grid.
+ */
+static inline SolverGrid_t mazeSolverGrid(Maze_t *maze) {
+    return (SolverGrid_t){false, maze, NULL, maze->width, maze->height};
+}
+
+/**@brief Creates a grid over a bit-plane maze.
+ *
+ * @param bits The maze to solve.
+ * @return The created grid.
+ */
+static inline SolverGrid_t bitsSolverGrid(MazeBits_t *bits) {
+    return (SolverGrid_t){true, NULL, bits, bits->width, bits->height};
+}
+
+/**@brief Gets the position of a cell in the layout of a grid.
+ *
+ * @param grid The grid the cell is in.
+ * @param point The location of the cell.
+ * @param index The index of the cell.
+ * @return The position of the cell.
+ */
+static inline size_t gridPos(const SolverGrid_t *grid, Point_t point,
+                             size_t index) {
+    return grid->packed ? mazeBitsPos(grid->bits, point) : index;
+}
+
+/**@brief Gets the position of the neighbour of a cell.
+ *
+ * @param grid The grid the cell is in.
+ * @param pos The position of the cell.
+ * @param dir The side of the cell the neighbour is on.
+ * @return The position of the neighbour.
+ */
+static inline size_t gridNeighbourPos(const SolverGrid_t *grid, size_t pos,
+                                      Direction_t dir) {
+    size_t row = grid->packed ? grid->bits->stride * 64 : grid->width;
+
+    switch (dir) {
+        case up:
+            return pos - row;
+        case down:
+            return pos + row;
+        case left:
+            return pos - 1;
+        case right:
+        default:
+            return pos + 1;
+    }
+}
+
+/**@brief Determines if a cell has been visited.
+ *
+ * @param grid The grid to read.
+ * @param pos The position of the cell.
+ * @return True if the cell has been visited.
+ */
+static inline bool gridVisited(const SolverGrid_t *grid, size_t pos) {
+    return grid->packed ? bitsTest(grid->bits->visited, pos)
+                        : grid->maze->cells[pos].visited;
+}
+
+/**@brief Marks a cell as visited.
+ *
+ * @param grid The grid to modify.
+ * @param pos The position of the cell.
+ * @return void
+ */
+static inline void gridSetVisited(const SolverGrid_t *grid, size_t pos) {
+    if (grid->packed) {
+        bitsSet(grid->bits->visited, pos);
+    } else {
+        grid->maze->cells[pos].visited = 1;
+    }
+}
+
+/**@brief Determines if a cell is enqueued.
+ *
+ * @param grid The grid to read.
+ * @param pos The position of the cell.
+ * @return True if the cell is enqueued.
+ */
+static inline bool gridQueued(const SolverGrid_t *grid, size_t pos) {
+    return grid->packed ? bitsTest(grid->bits->queued, pos)
+                        : grid->maze->cells[pos].queued;
+}
+
+/**@brief Marks if a cell is enqueued.
+ *
+ * @param grid The grid to modify.
+ * @param pos The position of the cell.
+ * @param queued True if the cell is enqueued.
+ * @return void
+ */
+static inline void gridSetQueued(const SolverGrid_t *grid, size_t pos,
+                                 bool queued) {
+    if (grid->packed) {
+        if (queued) {
+            bitsSet(grid->bits->queued, pos);
+        } else {
+            bitsClear(grid->bits->queued, pos);
+        }
+    } else {
+        grid->maze->cells[pos].queued = queued;
+    }
+}
+
+/**@brief Marks a cell as on the path.
+ *
+ * @param grid The grid to modify.
+ * @param pos The position of the cell.
+ * @return void
+ */
+static inline void gridSetPath(const SolverGrid_t *grid, size_t pos) {
+    if (grid->packed) {
+        bitsSet(grid->bits->path, pos);
+    } else {
+        grid->maze->cells[pos].path = 1;
+    }
+}
+
+/**@brief Determines if a cell can be left in a direction.
+ *
+ * @param grid The grid to read.
+ * @param point The location of the cell.
+ * @param pos The position of the cell.
+ * @param dir The direction to leave in.
+ * @return True if there is a neighbour and no wall in the way.
+ */
+static inline bool gridIsOpen(const SolverGrid_t *grid, Point_t point,
+                              size_t pos, Direction_t dir) {
+    Cell_t cell;
+
+    switch (dir) {
+        case up:
+            if (point.y == 0) {
+                return false;
+            }
+            break;
+        case down:
+            if (point.y == grid->height - 1) {
+                return false;
+            }
+            break;
+        case left:
+            if (point.x == 0) {
+                return false;
+            }
+            break;
+        case right:
+            if (point.x == grid->width - 1) {
+                return false;
+            }
+            break;
+    }
+
+    if (grid->packed) {
+        return !mazeBitsHasWall(grid->bits, point, dir);
+    }
+
+    cell = grid->maze->cells[pos];
+    switch (dir) {
+        case up:
+            return !cell.top;
+        case down:
+            return !cell.bottom;
+        case left:
+            return !cell.left;
+        case right:
+        default:
+            return !cell.right;
+    }
+}
+
+/**@brief Provides every direction traversable from a point.
+ *
+ * Directions come out in the same order as getValidTravelDirections().
+ *
+ * @param grid The grid being traversed.
+ * @param point The point to travel from.
+ * @param dir The directions to traverse.
+ * @return The number of traversable directions.
+ */
+static inline size_t gridTravelDirections(const SolverGrid_t *grid,
+                                          Point_t point, Direction_t dir[4]) {
+    return grid->packed ? mazeBitsTravelDirections(point, grid->bits, dir)
+                        : getValidTravelDirections(point, *grid->maze, dir);
+}
+
+#endif /* ifndef __SOLVER_GRID_H__ */
@@ -0,0 +1,116 @@
+/**@file solverWorkspace.h
+ * @brief Function prototypes for reusable solver workspaces.
+ *
+ * A workspace holds every per-cell array and queue a solver needs, so the
+ * memory is allocated once and shared by back-to-back solves. Distances are
+ * tagged with the epoch of the solve that wrote them, so starting a new solve
+ * only bumps the epoch instead of clearing the arrays.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __SOLVER_WORKSPACE_H__
+#define __SOLVER_WORKSPACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "packedDirections.h"
+#include "priorityQueue.h"
+
+/**@struct SolverWorkspace_t
+ * @brief A structure for the memory used by the solvers.
+ *
+ * @var SolverWorkspace_t::sz
+ * The number of cells the workspace can hold.
+ *
+ * @var SolverWorkspace_t::epoch
+ * The tag of the current solve.
+ *
+ * @var SolverWorkspace_t::stamps
+ * The epoch that last wrote each cell's distance.
+ *
+ * @var SolverWorkspace_t::distance
+ * The best known distance of each cell from the start.
+ *
+ * @var SolverWorkspace_t::parents
+ * The direction from each cell back to the cell it was reached from.
+ *
+ * @var SolverWorkspace_t::ring
+ * The FIFO used by breadth first.
+ *
+ * @var SolverWorkspace_t::buckets
+ * The bucket queue used by Dijkstra.
+ *
+ * @var SolverWorkspace_t::heap
+ * The indexed heap used by A-Star.
+ *
+ * @var SolverWorkspace_t::stack
+ * The direction stack used by depth first.
+ */
+typedef struct SolverWorkspace_t {
+    size_t sz;
+    uint32_t epoch;
+    uint32_t *stamps;
+    uint32_t *distance;
+    DirectionMap_t parents;
+    RingQueue_t ring;
+    BucketQueue_t buckets;
+    IndexedHeap_t heap;
+    DirectionStack_t stack;
+} SolverWorkspace_t;
+
+/**@brief Creates a workspace for mazes of up to sz cells.
+ *
+ * The per-cell arrays are only written as a solve reaches cells, so the pages
+ * of a large workspace stay unmapped until a solve needs them.
+ *
+ * @param sz The number of cells.
+ * @return The created workspace.
+ */
+SolverWorkspace_t createSolverWorkspace(size_t sz);
+
+/**@brief Prepares a workspace for a new solve.
+ *
+ * The workspace is grown if the maze has more cells than it can hold.
+ * Otherwise no memory is touched beyond the queued entries of the last solve.
+ *
+ * @param workspace The workspace to reset.
+ * @param sz The number of cells in the maze about to be solved.
+ * @return void
+ */
+void resetSolverWorkspace(SolverWorkspace_t *workspace, size_t sz);
+
+/**@brief Frees a workspace.
+ *
+ * @param workspace The workspace to free.
+ * @return void
+ */
+void freeSolverWorkspace(SolverWorkspace_t *workspace);
+
+/**@brief Gets the distance of a cell in the current solve.
+ *
+ * @param workspace The workspace to read.
+ * @param i The index of the cell.
+ * @return The distance, or UINT32_MAX if the cell has not been reached.
+ */
+static inline uint32_t workspaceDistance(const SolverWorkspace_t *workspace,
+                                         size_t i) {
+    return workspace->stamps[i] == workspace->epoch ? workspace->distance[i]
+                                                    : UINT32_MAX;
+}
+
+/**@brief Sets the distance of a cell in the current solve.
+ *
+ * @param workspace The workspace to modify.
+ * @param i The index of the cell.
+ * @param distance The new distance.
+ * @return void
+ */
+static inline void workspaceSetDistance(SolverWorkspace_t *workspace,
+                                        size_t i, uint32_t distance) {
+    workspace->stamps[i] = workspace->epoch;
+    workspace->distance[i] = distance;
+}
+
+#endif /* ifndef __SOLVER_WORKSPACE_H__ */
@@ -0,0 +1,114 @@
+/**@file stepObserver.h
+ * @brief The callbacks an algorithm reports its steps through.
+ *
+ * Every generator and solver has a single implementation that reports its
+ * steps to a StepObserver_t. The plain entry points pass a NULL observer to
+ * it, and since the implementation is forced inline into each entry point the
+ * checks below fold away, leaving the plain code without a trace of the
+ * observer.
+ *
+ * An algorithm reports every cell it changes with observeCell() (or
+ * observeWall() for both sides of a wall), then marks the end of a step with
+ * observeFrame(). Cells only changed for show (queued, observing) are only
+ * touched when there is an observer. observeDone() is called once the maze is
+ * finished.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __STEP_OBSERVER_H__
+#define __STEP_OBSERVER_H__
+
+#include <stddef.h>
+
+#include "MazeTools.h"
+
+/**@brief Marks the single implementation of an observed algorithm. */
+#if defined(__GNUC__)
+#define OBSERVED_INLINE static inline __attribute__((always_inline))
+#else
+#define OBSERVED_INLINE static inline
+#endif
+
+/**@struct StepObserver_t
+ * @brief A structure for the callbacks watching an algorithm.
+ *
+ * @var StepObserver_t::ctx
+ * Passed to every callback.
+ *
+ * @var StepObserver_t::cellChanged
+ * Called after the cell at index changed.
+ *
+ * @var StepObserver_t::frame
+ * Called at the end of every step, with how the maze should be drawn.
+ *
+ * @var StepObserver_t::done
+ * Called once with the finished maze.
+ */
+typedef struct StepObserver_t {
+    void *ctx;
+    void (*cellChanged)(void *ctx, const Maze_t *maze, size_t index);
+    void (*frame)(void *ctx, Maze_t *maze, renderFlags_t flags);
+    void (*done)(void *ctx, Maze_t *maze);
+} StepObserver_t;
+
+/**@brief Reports a changed cell.
+ *
+ * @param observer The observer, or NULL.
+ * @param maze The maze that changed.
+ * @param index The index of the changed cell.
+ * @return void
+ */
+static inline void observeCell(const StepObserver_t *observer,
+                               const Maze_t *maze, size_t index) {
+    if (observer) {
+        observer->cellChanged(observer->ctx, maze, index);
+    }
+}
+
+/**@brief Reports the two cells on either side of a changed wall.
+ *
+ * @param observer The observer, or NULL.
+ * @param maze The maze that changed.
+ * @param point The cell on one side of the wall.
+ * @param dir The side of point the wall is on.
+ * @return void
+ */
+static inline void observeWall(const StepObserver_t *observer,
+                               const Maze_t *maze, Point_t point,
+                               Direction_t dir) {
+    if (observer) {
+        observer->cellChanged(observer->ctx, maze,
+                              pointToIndex(point, maze->width));
+        observer->cellChanged(observer->ctx, maze,
+                              pointToIndex(pointShift(point, dir), maze->width));
+    }
+}
+
+/**@brief Ends a step.
+ *
+ * @param observer The observer, or NULL.
+ * @param maze The maze as of the end of the step.
+ * @param flags How the step should be drawn.
+ * @return void
+ */
+static inline void observeFrame(const StepObserver_t *observer, Maze_t *maze,
+                                renderFlags_t flags) {
+    if (observer) {
+        observer->frame(observer->ctx, maze, flags);
+    }
+}
+
+/**@brief Reports the finished maze.
+ *
+ * @param observer The observer, or NULL.
+ * @param maze The finished maze.
+ * @return void
+ */
+static inline void observeDone(const StepObserver_t *observer, Maze_t *maze) {
+    if (observer) {
+        observer->done(observer->ctx, maze);
+    }
+}
+
+#endif /* ifndef __STEP_OBSERVER_H__ */
@@ -0,0 +1,259 @@
+/**@file stepSink.h
+ * @brief Function prototypes for writing the steps of an algorithm.
+ *
+ * A StepSink_t is the step observer (see stepObserver.h) that writes the
+ * frames of an algorithm to a stream. Both formats compare the cells the
+ * algorithm reported as changed against a shadow copy of the cells from the
+ * last frame, so the cost of a frame follows the size of the step rather
+ * than the size of the maze. A text sink keeps one rendered frame and
+ * redraws only the cells that changed before writing it out. A delta sink
+ * writes a binary log holding, for each frame, only the cells whose flags
+ * changed; replayStepLog() turns such a log back into the text frames.
+ *
+ * A sink can hand its frames to a background writer thread, so the algorithm
+ * keeps running while the frames are written. The thread holds a bounded
+ * queue of frames; when it falls behind, the algorithm waits for a free slot.
+ *
+ * A sink can also thin out the frames. Steps that are not due are dropped
+ * before anything is rendered or diffed; the changes they made show up in the
+ * next frame that is written. The final maze is always written.
+ *
+ * A delta log starts with a StepLogHeader_t. Each frame that follows is one
+ * byte of STEP_FRAME_* flags, a varint count of changed cells, and for each
+ * changed cell a varint gap from the previous changed index and a varint mask
+ * of the CELL_FLAG_* bits that flipped. Varints are little-endian base 128.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#ifndef __STEP_SINK_H__
+#define __STEP_SINK_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "MazeTools.h"
+#include "stepObserver.h"
+
+/**@brief The magic bytes at the start of every delta step log. */
+#define STEP_LOG_MAGIC "MZD1"
+
+/**@brief The frame is the final maze and is not followed by a blank line. */
+#define STEP_FRAME_FINAL 0x01
+
+/**@brief The frame is drawn as if no cell was visited. */
+#define STEP_FRAME_IGNORE_VISITED 0x02
+
+/**@brief The cell flags recorded by a delta log. */
+enum {
+    CELL_FLAG_QUEUED = 1 << 0,
+    CELL_FLAG_OBSERVING = 1 << 1,
+    CELL_FLAG_PATH = 1 << 2,
+    CELL_FLAG_START = 1 << 3,
+    CELL_FLAG_STOP = 1 << 4,
+    CELL_FLAG_VISITED = 1 << 5,
+    CELL_FLAG_TOP = 1 << 6,
+    CELL_FLAG_BOTTOM = 1 << 7,
+    CELL_FLAG_LEFT = 1 << 8,
+    CELL_FLAG_RIGHT = 1 << 9
+};
+
+/**@brief The formats a step sink can write. */
+typedef enum {
+    textSteps, /**@brief Every frame rendered in full. */
+    deltaSteps /**@brief A binary log of the cells changed per frame. */
+} stepFormat_t;
+
+/**@struct StepLogHeader_t
+ * @brief The header of a delta step log.
+ *
+ * @var StepLogHeader_t::magic
+ * Always STEP_LOG_MAGIC.
+ *
+ * @var StepLogHeader_t::byteOrder
+ * Always MAZE_FILE_BYTE_ORDER as the writer saw it.
+ *
+ * @var StepLogHeader_t::width
+ * The width of the maze.
+ *
+ * @var StepLogHeader_t::height
+ * The height of the maze.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t byteOrder;
+    uint64_t width;
+    uint64_t height;
+} StepLogHeader_t;
+
+/**@brief The background writer of a sink (see startStepSinkWriter()). */
+struct StepWriter_t;
+
+/**@struct StepSink_t
+ * @brief A structure for the destination of an algorithm's steps.
+ *
+ * @var StepSink_t::stream
+ * The stream the steps are written to.
+ *
+ * @var StepSink_t::format
+ * The format the steps are written in.
+ *
+ * @var StepSink_t::shadow
+ * A copy of the cells as of the last frame, or NULL before the first.
+ *
+ * @var StepSink_t::sz
+ * The number of cells in shadow.
+ *
+ * @var StepSink_t::dirty
+ * One bit per chunk of cells in shadow, set when a cell in the chunk was
+ * reported as changed since the last frame.
+ *
+ * @var StepSink_t::text
+ * The last text frame, or NULL if none is held.
+ *
+ * @var StepSink_t::textSz
+ * The size of text, including the EOS.
+ *
+ * @var StepSink_t::textFlags
+ * How the cells in text are drawn.
+ *
+ * @var StepSink_t::buf
+ * The encoded changes of the frame being written.
+ *
+ * @var StepSink_t::bufSz
+ * The number of bytes used in buf.
+ *
+ * @var StepSink_t::bufCap
+ * The number of bytes allocated for buf.
+ *
+ * @var StepSink_t::last
+ * The last changed index encoded in buf.
+ *
+ * @var StepSink_t::changes
+ * The number of changes encoded in buf.
+ *
+ * @var StepSink_t::writer
+ * The background writer, or NULL if frames are written directly.
+ *
+ * @var StepSink_t::every
+ * The number of steps between written frames.
+ *
+ * @var StepSink_t::skipped
+ * The number of steps since the last written frame.
+ *
+ * @var StepSink_t::interval
+ * The minimum number of seconds between written frames, or 0.
+ *
+ * @var StepSink_t::next
+ * The monotonic time in seconds at which the next frame may be written.
+ */
+typedef struct StepSink_t {
+    FILE *stream;
+    stepFormat_t format;
+    Cell_t *shadow;
+    size_t sz;
+    uint64_t *dirty;
+    char *text;
+    size_t textSz;
+    renderFlags_t textFlags;
+    uint8_t *buf;
+    size_t bufSz;
+    size_t bufCap;
+    size_t last;
+    uint64_t changes;
+    struct StepWriter_t *writer;
+    uint64_t every;
+    uint64_t skipped;
+    double interval;
+    double next;
+} StepSink_t;
+
+/**@brief Creates a step sink.
+ *
+ * @param stream The stream to write the steps to.
+ * @param format The format to write the steps in.
+ * @return The created sink.
+ */
+StepSink_t createStepSink(FILE *stream, stepFormat_t format);
+
+/**@brief Limits how often a step sink writes frames.
+ *
+ * The first step is always written. After that a frame is written once every
+ * steps have passed and, if fps is set, once 1 / fps seconds have passed since
+ * the last frame was written.
+ *
+ * @param sink The sink to limit.
+ * @param every The number of steps per frame. 0 and 1 write every step.
+ * @param fps The maximum number of frames per second, or 0 for no limit.
+ * @return void
+ */
+void setStepSinkRate(StepSink_t *sink, uint64_t every, double fps);
+
+/**@brief Moves the writing of a sink's frames to a background thread.
+ *
+ * Each frame is copied into one of depth slots and written by the thread.
+ * When every slot is waiting to be written, the next frame blocks until one
+ * is free. The stream must not be used by anyone else until the sink is
+ * freed.
+ *
+ * @param sink The sink to write from a thread.
+ * @param depth The number of frames that can wait to be written.
+ * @return void
+ */
+void startStepSinkWriter(StepSink_t *sink, size_t depth);
+
+/**@brief Frees a step sink.
+ *
+ * Any frames still queued for the writer thread are written first. The
+ * stream is not closed.
+ *
+ * @param sink The sink to free.
+ * @return void
+ */
+void freeStepSink(StepSink_t *sink);
+
+/**@brief Determines if a path names a delta step log.
+ *
+ * @param path The path to check.
+ * @return True if the path ends in ".mzd".
+ */
+bool isStepLogPath(const char *path);
+
+/**@brief Creates the observer that writes an algorithm's steps to a sink.
+ *
+ * Steps that are not due (see setStepSinkRate()) are dropped before anything
+ * is rendered or diffed. When the algorithm is done the final maze is always
+ * written, and a text sink hands its frame over to the maze as its cached
+ * string, so the finished maze can be written again without rendering it.
+ *
+ * @param sink The sink to write to. It must outlive the observer.
+ * @return The observer.
+ */
+StepObserver_t stepSinkObserver(StepSink_t *sink);
+
+/**@brief Packs the flags of a cell.
+ *
+ * @param cell The cell to pack.
+ * @return The CELL_FLAG_* bits set in the cell.
+ */
+uint16_t cellToFlags(Cell_t cell);
+
+/**@brief Unpacks the flags of a cell.
+ *
+ * @param flags The CELL_FLAG_* bits to unpack.
+ * @return The cell.
+ */
+Cell_t flagsToCell(uint16_t flags);
+
+/**@brief Replays a delta step log as text frames.
+ *
+ * The output is the same as a text sink would have written.
+ *
+ * @param in The delta log to read.
+ * @param out The stream for the text frames.
+ * @return True if the whole log was valid.
+ */
+bool replayStepLog(FILE *in, FILE *out);
+
+#endif /* ifndef __STEP_SINK_H__ */
@@ -2,7 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "MazeTools.h"
 #include "aStar.h"
@@ -19,77 +20,110 @@
 #include "recursiveBacktracking.h"
 #include "recursiveDivision.h"
 #include "sidewinder.h"
+#include "solverWorkspace.h"
+#include "stepObserver.h"
 #include "wilson.h"
 
-Maze_t createMaze(const char *str) {
-    Maze_t maze = {0, 0, NULL, NULL};
-    size_t strWidth = 1;
-    size_t len = strlen(str);
-    size_t rows = 0;
-    Point_t point;
+// Parses the cell row between the wall lines above and below it.
+static void parseMazeRow(Maze_t *maze, size_t y, const char *above,
+                         const char *row, const char *below) {
+    Cell_t *cells = maze->cells + y * maze->width;
 
-    for (size_t i = 0; i < len; i += strWidth) {
-        if (str[i] == '\n') {
-            rows += 1;
-            if (strWidth == 1) {
-                maze.width = (i - 1) / 2;
-                strWidth = i + 1;
-            }
-        }
-    }
+    for (size_t x = 0; x < maze->width; x++) {
+        size_t strI = 2 * x + 1;
+        char c = row[strI];
+        Cell_t cell = {0};
 
-    if (str[len - 2] != '\n') {
-        rows += 1;
-    }
+        cell.visited = c == '.' || c == 's' || c == 'x' || c == '*';
+        cell.path = c == '*';
+        cell.queued = c == 'Q';
+        cell.observing = c == ':';
+        cell.start = c == 'S' || c == 's';
+        cell.stop = c == 'X' || c == 'x';
+        cell.left = row[strI - 1] == '#';
+        cell.right = row[strI + 1] == '#';
+        cell.top = above[strI] == '#';
+        cell.bottom = below[strI] == '#';
 
-    maze.height = (rows - 1) / 2;
+        cells[x] = cell;
+    }
+}
 
-    maze.cells = malloc(sizeof(*maze.cells) * maze.width * maze.height);
+// Parses a maze in one pass over the text. Rows are handled as soon as the
+// wall line below them is seen, so the text is never copied or rescanned.
+static Maze_t parseMaze(const char *str, size_t len) {
+    Maze_t maze = {0, 0, NULL, NULL};
+    const char *above = NULL;
+    const char *row = NULL;
+    const char *end;
+    size_t lineLen;
+    size_t lines = 0;
+    size_t maxRows;
+    size_t pos = 0;
+
+    end = memchr(str, '\n', len);
+    lineLen = end ? (size_t)(end - str) : len;
+    if (lineLen < 3 || lineLen % 2 == 0) {
+        fprintf(stderr, "Invalid maze: first row is %zu characters wide\n",
+                lineLen);
+        return maze;
+    }
+
+    maze.width = (lineLen - 1) / 2;
+
+    // every line is lineLen characters and a newline, so the length of the
+    // text bounds the number of cell rows
+    maxRows = ((len + 1) / (lineLen + 1)) / 2;
+    maze.cells = malloc(sizeof(*maze.cells) * maze.width * (maxRows ? maxRows : 1));
+    if (maze.cells == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
+    }
 
-    for (point.y = 0; point.y < maze.height; ++point.y) {
-        for (point.x = 0; point.x < maze.width; ++point.x) {
-            size_t i = pointToIndex(point, maze.width);
-            size_t strI = strWidth * (2 * point.y + 1) + 2 * point.x + 1;
+    while (pos < len) {
+        const char *line = str + pos;
+        size_t remaining = len - pos;
 
-            if (str[strI] == '.' || str[strI] == 's' || str[strI] == 'x') {
-                maze.cells[i].visited = 1;
-            } else {
-                maze.cells[i].visited = 0;
-            }
+        // tolerate blank lines after the maze
+        if (line[0] == '\n') {
+            break;
+        }
 
-            if (str[strI] == '*') {
-                maze.cells[i].path = 1;
-                maze.cells[i].visited = 1;
-            } else {
-                maze.cells[i].path = 0;
-            }
+        // only look as far as the newline that should end this line
+        end = memchr(line, '\n', remaining < lineLen + 1 ? remaining : lineLen + 1);
+        if ((end ? (size_t)(end - line) : remaining) != lineLen) {
+            fprintf(stderr, "Invalid maze: line %zu is not %zu characters wide\n",
+                    lines + 1, lineLen);
+            free(maze.cells);
+            return (Maze_t){0, 0, NULL, NULL};
+        }
 
-            maze.cells[i].queued = str[strI] == 'Q' ? 1 : 0;
-            maze.cells[i].observing = str[strI] == ':' ? 1 : 0;
-
-            if (str[strI] == 'S' || str[strI] == 's') {
-                maze.cells[i].start = 1;
-                maze.cells[i].stop = 0;
-            } else if (str[strI] == 'X' || str[strI] == 'x') {
-                maze.cells[i].start = 0;
-                maze.cells[i].stop = 1;
-            } else {
-                maze.cells[i].start = 0;
-                maze.cells[i].stop = 0;
+        if (lines % 2 == 1) {
+            row = line;
+        } else {
+            if (lines > 0) {
+                parseMazeRow(&maze, maze.height++, above, row, line);
             }
-
-            maze.cells[i].left = str[strI - 1] == '#' ? 1 : 0;
-            maze.cells[i].right = str[strI + 1] == '#' ? 1 : 0;
-            maze.cells[i].top = str[strI - strWidth] == '#' ? 1 : 0;
-            maze.cells[i].bottom = str[strI + strWidth] == '#' ? 1 : 0;
+            above = line;
         }
+
+        lines++;
+        pos += lineLen + 1;
     }
 
-    maze.str = strdup(str);
+    if (lines % 2 == 0 || maze.height == 0) {
+        fprintf(stderr, "Invalid maze: missing the bottom wall line\n");
+        free(maze.cells);
+        return (Maze_t){0, 0, NULL, NULL};
+    }
 
     return maze;
 }
 
+Maze_t createMaze(const char *str) {
+    return parseMaze(str, strlen(str));
+}
+
 Maze_t createMazeWH(size_t width, size_t height) {
     Maze_t maze = {width, height, NULL, NULL};
     size_t sz = width * height;
@@ -117,26 +151,47 @@ Maze_t createMazeWH(size_t width, size_t height) {
 }
 
 Maze_t importMaze(FILE *stream) {
+    struct stat info;
     char *buf = NULL;
-    char c;
-    size_t maxSz = 100;
+    size_t maxSz = 1 << 20;
     size_t sz = 0;
+    size_t n;
     Maze_t maze = {0, 0, NULL, NULL};
 
+    // regular files are parsed straight out of the page cache
+    if (fstat(fileno(stream), &info) == 0 && S_ISREG(info.st_mode) &&
+        info.st_size > 0 && ftello(stream) == 0) {
+        buf = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fileno(stream),
+                   0);
+        if (buf != MAP_FAILED) {
+            madvise(buf, info.st_size, MADV_SEQUENTIAL);
+            maze = parseMaze(buf, info.st_size);
+            munmap(buf, info.st_size);
+            return maze;
+        }
+    }
+
+    // pipes and terminals are read in large blocks
     buf = malloc(sizeof(*buf) * maxSz);
+    if (buf == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
+    }
 
-    while ((c = fgetc(stream)) != EOF) {
-        buf[sz++] = c;
+    while ((n = fread(buf + sz, 1, maxSz - sz, stream)) > 0) {
+        sz += n;
 
-        if (sz >= maxSz) {
-            maxSz += 100;
+        if (sz == maxSz) {
+            maxSz *= 2;
             buf = realloc(buf, sizeof(*buf) * maxSz);
+            if (buf == NULL) {
+                perror("Failed to allocate maze");
+                exit(EXIT_FAILURE);
+            }
         }
     }
 
-    buf[sz++] = '\0';
-
-    maze = createMaze(buf);
+    maze = parseMaze(buf, sz);
 
     free(buf);
 
@@ -214,6 +269,20 @@ Point_t pointShift(Point_t point, Direction_t direction) {
     }
 }
 
+Direction_t oppositeDirection(Direction_t direction) {
+    switch (direction) {
+        case up:
+            return down;
+        case down:
+            return up;
+        case left:
+            return right;
+        case right:
+        default:
+            return left;
+    }
+}
+
 inline size_t pointToIndex(Point_t point, size_t width) {
     return point.y * width + point.x;
 }
@@ -239,7 +308,7 @@ uint64_t manhattenDistance(Point_t p1, Point_t p2) {
 	return difx + dify;
 }
 
-Direction_t getRandomDirection(Point_t point, Maze_t maze) {
+Direction_t getRandomDirection(Point_t point, Maze_t maze, MazeRng_t *rng) {
     Direction_t dir[4];
     size_t dirSz = 0;
 
@@ -259,40 +328,46 @@ Direction_t getRandomDirection(Point_t point, Maze_t maze) {
         dir[dirSz++] = down;
     }
 
-    return dir[rand() % dirSz];
+    return dir[mazeRngBelow(rng, dirSz)];
 }
 
-size_t getRandomDirections(Point_t point, Maze_t maze, Direction_t dir[4]) {
-    size_t dirSz = 0;
-
-    if (point.x > 0) {
-        dir[dirSz++] = left;
-    }
-
-    if (point.x < maze.width - 1) {
-        dir[dirSz++] = right;
-    }
+// every ordering of the four directions
+static const uint8_t directionOrders[24][4] = {
+    {up, down, left, right}, {up, down, right, left}, {up, left, down, right},
+    {up, left, right, down}, {up, right, down, left}, {up, right, left, down},
+    {down, up, left, right}, {down, up, right, left}, {down, left, up, right},
+    {down, left, right, up}, {down, right, up, left}, {down, right, left, up},
+    {left, up, down, right}, {left, up, right, down}, {left, down, up, right},
+    {left, down, right, up}, {left, right, up, down}, {left, right, down, up},
+    {right, up, down, left}, {right, up, left, down}, {right, down, up, left},
+    {right, down, left, up}, {right, left, up, down}, {right, left, down, up},
+};
 
-    if (point.y > 0) {
-        dir[dirSz++] = up;
-    }
-
-    if (point.y < maze.height - 1) {
-        dir[dirSz++] = down;
-    }
+size_t getRandomDirections(Point_t point, Maze_t maze, Direction_t dir[4],
+                           MazeRng_t *rng) {
+    const uint8_t *order = directionOrders[mazeRngBelow(rng, 24)];
+    size_t dirSz = 0;
+    bool open[4];
 
-    for (size_t i = 0; i < 20; i++) {
-        size_t left = rand() % dirSz;
-        size_t right = rand() % dirSz;
+    open[up] = point.y > 0;
+    open[down] = point.y < maze.height - 1;
+    open[left] = point.x > 0;
+    open[right] = point.x < maze.width - 1;
 
-        Direction_t tmp = dir[left];
-        dir[left] = dir[right];
-        dir[right] = tmp;
+    // dropping the blocked directions keeps the rest uniformly ordered
+    for (size_t i = 0; i < 4; i++) {
+        if (open[order[i]]) {
+            dir[dirSz++] = order[i];
+        }
     }
 
     return dirSz;
 }
 
+void skipRandomDirections(MazeRng_t *rng) {
+    mazeRngBelow(rng, 24);
+}
+
 size_t getValidDirections(Point_t point, Maze_t maze, Direction_t dir[4]) {
     size_t dirSz = 0;
 
@@ -338,43 +413,31 @@ size_t getValidTravelDirections(Point_t point, Maze_t maze, Direction_t dir[4])
     return dirSz;
 }
 
-Tree_t *getHead(Tree_t *tree) {
-    if (!tree) return tree;
-
-    while (tree->parent != NULL) {
-        // printf("%p -> %p\n", tree, tree->parent);
-        tree = tree->parent;
-    }
-
-    return tree;
-}
+bool solveMaze(Maze_t *maze, Point_t start, Point_t stop,
+               solveAlgo_t algorithm) {
+    SolverWorkspace_t workspace = createSolverWorkspace(maze->width * maze->height);
+    bool state = solveMazeInWorkspace(maze, start, stop, algorithm, &workspace);
 
-bool isSameTree(Tree_t *tree1, Tree_t *tree2) {
-    tree1 = getHead(tree1);
-    tree2 = getHead(tree2);
+    freeSolverWorkspace(&workspace);
 
-    return tree1->val == tree2->val;
+    return state;
 }
 
-bool solveMaze(Maze_t *maze, Point_t start, Point_t stop,
-               solveAlgo_t algorithm) {
+bool solveMazeInWorkspace(Maze_t *maze, Point_t start, Point_t stop,
+                          solveAlgo_t algorithm, SolverWorkspace_t *workspace) {
     bool state = false;
     switch (algorithm) {
         case depthFirst:
-            state = depthFirstSolve(maze, start, stop);
-			if (maze->str) {
-				free(maze->str);
-			}
-			maze->str = graphToString(maze->cells, maze->width, maze->height);
+            state = depthFirstSolve(maze, start, stop, workspace);
             break;
         case breadthFirst:
-            state = breadthFirstSolve(maze, start, stop);
+            state = breadthFirstSolve(maze, start, stop, workspace);
           break;
 		case dijkstra:
-            state = dijkstraSolve(maze, start, stop);
+            state = dijkstraSolve(maze, start, stop, workspace);
 			break;
 		case aStar:
-            state = aStarSolve(maze, start, stop);
+            state = aStarSolve(maze, start, stop, workspace);
 			break;
         case INVALID_SOLVER:
             break;
@@ -383,34 +446,43 @@ bool solveMaze(Maze_t *maze, Point_t start, Point_t stop,
     return state;
 }
 
-bool solveMazeWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                        solveAlgo_t algorithm, FILE *stream) {
+bool solveMazeObserved(Maze_t *maze, Point_t start, Point_t stop,
+                       solveAlgo_t algorithm, const StepObserver_t *observer) {
+    SolverWorkspace_t workspace = createSolverWorkspace(maze->width * maze->height);
     bool state = false;
     switch (algorithm) {
         case depthFirst:
-            state = depthFirstSolveWithSteps(maze, start, stop, stream);
-			if (maze->str) {
-				free(maze->str);
-			}
-			maze->str = graphToString(maze->cells, maze->width, maze->height);
-			fputs(maze->str, stream);
+            state = depthFirstSolveObserved(maze, start, stop, &workspace,
+                                            observer);
             break;
         case breadthFirst:
-            state = breadthFirstSolveWithSteps(maze, start, stop, stream);
+            state = breadthFirstSolveObserved(maze, start, stop, &workspace,
+                                              observer);
           break;
         case dijkstra:
-            state = dijkstraSolveWithSteps(maze, start, stop, stream);
+            state = dijkstraSolveObserved(maze, start, stop, &workspace, observer);
 			break;
         case aStar:
-            state = aStarSolveWithSteps(maze, start, stop, stream);
+            state = aStarSolveObserved(maze, start, stop, &workspace, observer);
 			break;
         case INVALID_SOLVER:
             break;
         }
 
+    freeSolverWorkspace(&workspace);
+
     return state;
 }
 
+// Applies the render flags to a copy of a cell.
+static inline Cell_t viewCell(Cell_t cell, renderFlags_t flags) {
+    if (flags & renderIgnoreVisited) {
+        cell.visited = 0;
+    }
+
+    return cell;
+}
+
 static char getCellPathChar(Cell_t cell1, Cell_t cell2) {
     char c = ' ';
 
@@ -425,131 +497,239 @@ static char getCellPathChar(Cell_t cell1, Cell_t cell2) {
     return c;
 }
 
-char *graphToString(Cell_t *cells, size_t width, size_t height) {
+size_t mazeStringSize(size_t width, size_t height) {
+    return (width * 2 + 1 + 1) * (height * 2 + 1) + 1;
+}
+
+static char getCellChar(Cell_t cell) {
+    char c = ' ';
+
+    if (cell.queued) {
+        c = cell.visited == 1 ? 'q' : 'Q';
+    }
+
+    if (cell.observing) {
+        c = ':';
+    }
+
+    if (cell.visited) {
+        c = '.';
+    }
+
+    if (cell.path) {
+        c = '*';
+    }
+
+    if (cell.start == 1) {
+        c = cell.visited == 1 ? 's' : 'S';
+    } else if (cell.stop == 1) {
+        c = cell.visited == 1 ? 'x' : 'X';
+    }
+
+    return c;
+}
+
+void renderMazeTopLine(const Cell_t *row, size_t width, char *line) {
+    line[0] = '#';
+    for (size_t x = 0; x < width; x++) {
+        line[2 * x + 1] = row[x].top ? '#' : ' ';
+        line[2 * x + 2] = '#';
+    }
+    line[2 * width + 1] = '\n';
+}
+
+// Renders a row and the wall line below it, drawing the cells through flags.
+static void renderRowBand(const Cell_t *row, const Cell_t *next, size_t width,
+                          char *band, renderFlags_t flags) {
     // In order to stringify, walls will be treated as #, and blanks as ' '
-    // There is a border that will surround the maze
-    // By treating a cell as a 2x2 grid, and stacking them, we get pretty close
-    // However, this would leave the following maze for a 2x2 maze
-    // ####
-    // # #
-    // ####
-    // # #
-    // Notice that it's missing the right and bottom border
-    // So we need to add one more layer to get the following maze
-    // #####
-    // # # #
-    // #####
-    // # # #
-    // #####
-    // Now, because this is a string representation, each line needs a newline
-    // So we increase the width by 1. The standard will include the newline for
-    // the last line. One more character will be added to the size for the EOS.
+    // Each cell is the odd column of the odd line it sits on. The characters
+    // between two cells show the wall between them, and every corner is a
+    // wall. An open wall between two visited or path cells shows the trail.
+    char *line = band;
+    char *below = band + 2 * width + 2;
+
+    line[0] = row[0].left ? '#' : ' ';
+    below[0] = '#';
+
+    for (size_t x = 0; x < width; x++) {
+        Cell_t cell = viewCell(row[x], flags);
+
+        line[2 * x + 1] = getCellChar(cell);
+
+        if (x + 1 == width) {
+            line[2 * x + 2] = cell.right ? '#' : ' ';
+        } else if (cell.right == 0 || row[x + 1].left == 0) {
+            line[2 * x + 2] = getCellPathChar(cell, viewCell(row[x + 1], flags));
+        } else {
+            line[2 * x + 2] = '#';
+        }
+
+        if (next == NULL) {
+            below[2 * x + 1] = cell.bottom ? '#' : ' ';
+        } else if (cell.bottom == 0 || next[x].top == 0) {
+            below[2 * x + 1] = getCellPathChar(cell, viewCell(next[x], flags));
+        } else {
+            below[2 * x + 1] = '#';
+        }
+        below[2 * x + 2] = '#';
+    }
+
+    line[2 * width + 1] = '\n';
+    below[2 * width + 1] = '\n';
+}
+
+void renderMazeRowBand(const Cell_t *row, const Cell_t *next, size_t width,
+                       char *band) {
+    renderRowBand(row, next, width, band, renderPlain);
+}
+
+static void renderGraph(const Cell_t *cells, size_t width, size_t height,
+                        char *str, renderFlags_t flags) {
+    // There is a border that will surround the maze, so a w x h maze is
+    // 2w + 1 characters wide and 2h + 1 lines tall. Each line ends in a
+    // newline, and one more character is added for the EOS.
     size_t strWidth = width * 2 + 1 + 1;
-    size_t strHeight = height * 2 + 1;
-    size_t sz = strWidth * strHeight + 1;
-    char *str = malloc(sizeof(*str) * sz);
-    Point_t point;
+
+    renderMazeTopLine(cells, width, str);
+    for (size_t y = 0; y < height; y++) {
+        const Cell_t *row = cells + y * width;
+
+        renderRowBand(row, y + 1 < height ? row + width : NULL, width,
+                      str + strWidth * (2 * y + 1), flags);
+    }
+
+    str[strWidth * (height * 2 + 1)] = '\0';
+}
+
+char *graphToString(Cell_t *cells, size_t width, size_t height) {
+    char *str = malloc(sizeof(*str) * mazeStringSize(width, height));
 
     if (str == NULL) {
         perror("Failed to allocate maze");
         exit(EXIT_FAILURE);
     }
 
-    memset(str, '#', sz);  // set everything to walls
-
-    // set EOS
-    str[sz - 1] = '\0';
+    renderGraph(cells, width, height, str, renderPlain);
 
-    // set first newline
-    str[strWidth - 1] = '\n';
+    return str;
+}
 
-    // setup cells
-    for (point.y = 0; point.y < height; ++point.y) {
-        for (point.x = 0; point.x < width; ++point.x) {
-            size_t i = pointToIndex(point, width);
-            size_t strI = strWidth * (2 * point.y + 1) + 2 * point.x + 1;
-            if (strI > sz) {
-                printf("ERROR: (%u, %u)\n", point.x, point.y);
-                exit(EXIT_FAILURE);
-            }
-            str[strI] = ' ';
+size_t renderMaze(const Maze_t *maze, char *buf, size_t sz,
+                  renderFlags_t flags) {
+    size_t needed = mazeStringSize(maze->width, maze->height);
 
-            if (cells[i].top == 0) {
-                str[strI - strWidth] =
-                    getCellPathChar(cells[i], cells[i - width]);
-            }
+    if (buf != NULL && sz >= needed) {
+        renderGraph(maze->cells, maze->width, maze->height, buf, flags);
+    }
 
-            if (cells[i].bottom == 0) {
-                str[strI + strWidth] =
-                    getCellPathChar(cells[i], cells[i + width]);
-            }
+    return needed;
+}
 
-            if (cells[i].left == 0) {
-                str[strI - 1] = getCellPathChar(cells[i], cells[i - 1]);
-            }
+void patchMazeString(const Maze_t *maze, char *str, size_t index,
+                     renderFlags_t flags) {
+    size_t strWidth = maze->width * 2 + 1 + 1;
+    size_t x = index % maze->width;
+    size_t y = index / maze->width;
+    const Cell_t *cells = maze->cells;
+    Cell_t cell = viewCell(cells[index], flags);
+    char *line = str + strWidth * (2 * y + 1) + 2 * x + 1;
 
-            if (cells[i].right == 0) {
-                str[strI + 1] = getCellPathChar(cells[i], cells[i + 1]);
-            }
+    // the same rules as renderRowBand(), for the five characters a cell owns
+    // or shares with a neighbour
+    *line = getCellChar(cell);
 
-            if (cells[i].queued) {
-                str[strI] = cells[i].visited == 1 ? 'q' : 'Q';
-            }
+    if (x == 0) {
+        line[-1] = cell.left ? '#' : ' ';
+    } else if (cells[index - 1].right == 0 || cell.left == 0) {
+        line[-1] = getCellPathChar(viewCell(cells[index - 1], flags), cell);
+    } else {
+        line[-1] = '#';
+    }
 
-            if (cells[i].observing) {
-                str[strI] = ':';
-            }
+    if (x + 1 == maze->width) {
+        line[1] = cell.right ? '#' : ' ';
+    } else if (cell.right == 0 || cells[index + 1].left == 0) {
+        line[1] = getCellPathChar(cell, viewCell(cells[index + 1], flags));
+    } else {
+        line[1] = '#';
+    }
 
-            if (cells[i].visited) {
-                str[strI] = '.';
-            }
+    if (y == 0) {
+        line[-strWidth] = cell.top ? '#' : ' ';
+    } else if (cells[index - maze->width].bottom == 0 || cell.top == 0) {
+        line[-strWidth] =
+            getCellPathChar(viewCell(cells[index - maze->width], flags), cell);
+    } else {
+        line[-strWidth] = '#';
+    }
 
-            if (cells[i].path) {
-                str[strI] = '*';
-            }
+    if (y + 1 == maze->height) {
+        line[strWidth] = cell.bottom ? '#' : ' ';
+    } else if (cell.bottom == 0 || cells[index + maze->width].top == 0) {
+        line[strWidth] =
+            getCellPathChar(cell, viewCell(cells[index + maze->width], flags));
+    } else {
+        line[strWidth] = '#';
+    }
+}
 
-            if (cells[i].start == 1) {
-                str[strI] = cells[i].visited == 1 ? 's' : 'S';
-            } else if (cells[i].stop == 1) {
-                str[strI] = cells[i].visited == 1 ? 'x' : 'X';
-            }
+// Writes the cells of a maze, ignoring any cached string.
+static void writeMaze(FILE *restrict stream, const Maze_t *maze,
+                      renderFlags_t flags) {
+    size_t strWidth = maze->width * 2 + 1 + 1;
+    char *band;
 
-            if (point.x + 1 == width) {
-                str[strI + 2] = '\n';
-                if (point.y + 1 != height) {
-                    str[strI + strWidth + 2] = '\n';
-                }
-            }
-        }
+    // only two lines are ever held, so any size of maze can be written
+    band = malloc(sizeof(*band) * strWidth * 2);
+    if (band == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
     }
 
-    // last newline
-    str[sz - 2] = '\n';
+    renderMazeTopLine(maze->cells, maze->width, band);
+    fwrite(band, 1, strWidth, stream);
 
-    return str;
-}
+    for (size_t y = 0; y < maze->height; y++) {
+        const Cell_t *row = maze->cells + y * maze->width;
 
-void fprintStep(FILE *restrict stream, Maze_t *maze) {
-    char *str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(str, stream);
-    fputc('\n', stream);
-    free(str);
+        renderRowBand(row, y + 1 < maze->height ? row + maze->width : NULL,
+                      maze->width, band, flags);
+        fwrite(band, 1, strWidth * 2, stream);
+    }
+
+    free(band);
 }
 
-void fprintStepIgnoreVisted(FILE *restrict stream, Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    bool visited[sz];
+void fprintMaze(FILE *restrict stream, const Maze_t *maze) {
+    if (maze->str) {
+        fputs(maze->str, stream);
+    } else {
+        writeMaze(stream, maze, renderPlain);
+    }
+}
 
-    for (size_t i = 0; i < sz; i++) {
-        visited[i] = maze->cells[i].visited == 1;
-        maze->cells[i].visited = 0;
+const char *getMazeString(Maze_t *maze) {
+    if (maze->str == NULL) {
+        maze->str = graphToString(maze->cells, maze->width, maze->height);
     }
 
-    fprintStep(stream, maze);
+    return maze->str;
+}
 
-    for (size_t i = 0; i < sz; i++) {
-        maze->cells[i].visited = visited[i] ? 1 : 0;
-    }
+void invalidateMazeString(Maze_t *maze) {
+    free(maze->str);
+    maze->str = NULL;
+}
+
+void fprintStep(FILE *restrict stream, const Maze_t *maze) {
+    // the cells change between steps without dropping the cache
+    writeMaze(stream, maze, renderPlain);
+    fputc('\n', stream);
+}
+
+void fprintStepIgnoreVisted(FILE *restrict stream, const Maze_t *maze) {
+    writeMaze(stream, maze, renderIgnoreVisited);
+    fputc('\n', stream);
 }
 
 void freeMaze(Maze_t maze) {
@@ -557,222 +737,141 @@ void freeMaze(Maze_t maze) {
     free(maze.cells);
 }
 
-void generateMaze(Maze_t *maze, genAlgo_t algorithm) {
+void generateMaze(Maze_t *maze, genAlgo_t algorithm, MazeRng_t *rng) {
+    invalidateMazeString(maze);
+
     switch (algorithm) {
         case kruskal:
-            kruskalGen(maze);
+            kruskalGen(maze, rng);
             break;
         case prim:
-            primGen(maze);
+            primGen(maze, rng);
             break;
         case back:
-            recursiveBacktracking(maze);
+            recursiveBacktracking(maze, rng);
             break;
         case aldous_broder:
-            aldousBroder(maze);
+            aldousBroder(maze, rng);
             break;
         case growing_tree:
-            growingTreeGen(maze, newest_randomTree, 0.5);
+            growingTreeGen(maze, newest_randomTree, 0.5, rng);
             break;
         case hunt_and_kill:
-            huntAndKillGen(maze);
+            huntAndKillGen(maze, rng);
             break;
         case wilson:
-            wilsonGen(maze);
+            wilsonGen(maze, rng);
             break;
         case eller:
-            ellerGen(maze);
+            ellerGen(maze, rng);
             break;
         case rDivide:
-            recursiveDivisionGen(maze);
+            recursiveDivisionGen(maze, rng);
             break;
         case sidewinder:
-            sidewinderGen(maze);
+            sidewinderGen(maze, rng);
             break;
         case binaryTree:
-            binaryTreeGen(maze, southWestTree);
+            binaryTreeGen(maze, southWestTree, rng);
             break;
         case INVALID_ALGORITHM:
             break;
     }
 }
 
-void generateMazeWithSteps(Maze_t *maze, genAlgo_t algorithm,
-                           FILE *restrict stream) {
+void generateMazeObserved(Maze_t *maze, genAlgo_t algorithm, MazeRng_t *rng,
+                          const StepObserver_t *observer) {
+    invalidateMazeString(maze);
+
     switch (algorithm) {
         case kruskal:
-            kruskalGenWithSteps(maze, stream);
+            kruskalGenObserved(maze, rng, observer);
             break;
         case prim:
-            primGenWithSteps(maze, stream);
+            primGenObserved(maze, rng, observer);
             break;
         case back:
-            recursiveBacktrackingWithSteps(maze, stream);
+            recursiveBacktrackingObserved(maze, rng, observer);
             break;
         case aldous_broder:
-            aldousBroderWithSteps(maze, stream);
+            aldousBroderObserved(maze, rng, observer);
             break;
         case growing_tree:
-            growingTreeGenWithSteps(maze, newest_randomTree, 0.5, stream);
+            growingTreeGenObserved(maze, newest_randomTree, 0.5, rng,
+                                   observer);
             break;
         case hunt_and_kill:
-            huntAndKillGenWithSteps(maze, stream);
+            huntAndKillGenObserved(maze, rng, observer);
             break;
         case wilson:
-            wilsonGenWithSteps(maze, stream);
+            wilsonGenObserved(maze, rng, observer);
             break;
         case eller:
-            ellerGenWithSteps(maze, stream);
+            ellerGenObserved(maze, rng, observer);
             break;
         case rDivide:
-            recursiveDivisionGenWithSteps(maze, stream);
+            recursiveDivisionGenObserved(maze, rng, observer);
             break;
         case sidewinder:
-            sidewinderGenWithSteps(maze, stream);
+            sidewinderGenObserved(maze, rng, observer);
             break;
         case binaryTree:
-            binaryTreeGenWithSteps(maze, southWestTree, stream);
+            binaryTreeGenObserved(maze, southWestTree, rng, observer);
             break;
         case INVALID_ALGORITHM:
             break;
     }
 }
 
-Tree_t *removeNode(Tree_t **head, int val) {
-    Tree_t *node = *head;
-    Tree_t *left, *right, *parent;
-
-    while (!node && node->val != val) {
-        if (node->val < val) {
-            node = node->right;
-        } else {
-            node = node->left;
-        }
-    }
-
-    if (!node) {
-        left = node->left;
-        right = node->right;
-        parent = node->parent;
-
-        node->parent = NULL;
-        node->left = NULL;
-        node->right = NULL;
-
-        // node is the head node
-        if (!parent) {
-            if (!left) {
-                *head = left;
-                left->parent = NULL;
-                joinTrees(*head, right);
-            } else {
-                right->parent = NULL;
-                *head = right;
-            }
-            // node is the parents left node
-        } else if (parent->left == node) {
-            parent->left = NULL;
-            // node is the parents right node
-        } else {
-            parent->right = NULL;
-        }
-
-        // The next to ifs only run when node was not the head node
-        if (parent && !left) {
-            left->parent = NULL;
-            joinTrees(parent, left);
-        }
-
-        if (parent && !right) {
-            right->parent = NULL;
-            joinTrees(parent, right);
-        }
-    }
-
-    return node;
-}
-
-void joinTrees(Tree_t *head, Tree_t *node) {
-    if (!head || !node) {
-        return;
-    }
-
-    node = getHead(node);
-
-    if (head->val < node->val) {
-        if (head->left == NULL) {
-            node->parent = head;
-            head->left = node;
+void getRandomStartAndStop(size_t width, size_t height, MazeRng_t *rng,
+                           Point_t *start, Point_t *stop) {
+    if (mazeRngCoin(rng)) {
+        start->x = mazeRngBelow(rng, width);
+        stop->x = mazeRngBelow(rng, width);
+        if (mazeRngCoin(rng)) {
+            start->y = 0;
+            stop->y = height - 1;
         } else {
-            joinTrees(head->left, node);
+            start->y = height - 1;
+            stop->y = 0;
         }
-    } else if (head->val > node->val) {
-        if (head->right == NULL) {
-            node->parent = head;
-            head->right = node;
+    } else {
+        start->y = mazeRngBelow(rng, height);
+        stop->y = mazeRngBelow(rng, height);
+        if (mazeRngCoin(rng)) {
+            start->x = 0;
+            stop->x = width - 1;
         } else {
-            joinTrees(head->right, node);
+            start->x = width - 1;
+            stop->x = 0;
         }
     }
 }
 
-void assignRandomStartAndStop(Maze_t *maze) {
+OBSERVED_INLINE void assignStartAndStop(Maze_t *maze, MazeRng_t *rng,
+                                        const StepObserver_t *observer) {
     Point_t start, stop;
+    size_t startIndex, stopIndex;
 
-    if (rand() % 2 == 0) {
-        start.x = rand() % maze->width;
-        stop.x = rand() % maze->width;
-        if (rand() % 2 == 0) {
-            start.y = 0;
-            stop.y = maze->height - 1;
-        } else {
-            start.y = maze->height - 1;
-            stop.y = 0;
-        }
-    } else {
-        start.y = rand() % maze->height;
-        stop.y = rand() % maze->height;
-        if (rand() % 2 == 0) {
-            start.x = 0;
-            stop.x = maze->width - 1;
-        } else {
-            start.x = maze->width - 1;
-            stop.x = 0;
-        }
-    }
+    getRandomStartAndStop(maze->width, maze->height, rng, &start, &stop);
 
-    maze->cells[pointToIndex(start, maze->width)].start = 1;
-    maze->cells[pointToIndex(stop, maze->height)].stop = 1;
-}
+    startIndex = pointToIndex(start, maze->width);
+    stopIndex = pointToIndex(stop, maze->width);
 
-void assignRandomStartAndStopWithSteps(Maze_t *maze, FILE *restrict stream) {
-    Point_t start, stop;
+    maze->cells[startIndex].start = 1;
+    observeCell(observer, maze, startIndex);
+    observeFrame(observer, maze, renderPlain);
+    maze->cells[stopIndex].stop = 1;
+    observeCell(observer, maze, stopIndex);
+}
 
-    if (rand() % 2 == 0) {
-        start.x = rand() % maze->width;
-        stop.x = rand() % maze->width;
-        if (rand() % 2 == 0) {
-            start.y = 0;
-            stop.y = maze->height - 1;
-        } else {
-            start.y = maze->height - 1;
-            stop.y = 0;
-        }
-    } else {
-        start.y = rand() % maze->height;
-        stop.y = rand() % maze->height;
-        if (rand() % 2 == 0) {
-            start.x = 0;
-            stop.x = maze->width - 1;
-        } else {
-            start.x = maze->width - 1;
-            stop.x = 0;
-        }
-    }
+void assignRandomStartAndStop(Maze_t *maze, MazeRng_t *rng) {
+    assignStartAndStop(maze, rng, NULL);
+}
 
-    maze->cells[pointToIndex(start, maze->width)].start = 1;
-    fprintStep(stream, maze);
-    maze->cells[pointToIndex(stop, maze->width)].stop = 1;
+void assignRandomStartAndStopObserved(Maze_t *maze, MazeRng_t *rng,
+                                      const StepObserver_t *observer) {
+    assignStartAndStop(maze, rng, observer);
 }
 
 genAlgo_t strToGenAlgo(const char *str) {
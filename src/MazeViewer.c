@@ -7,5 +7,5 @@ void printMaze(Maze_t maze) {
 		printf("%.*s\n", (int)maze.width, maze.str + i * maze.width);
 	}
 	*/
-	printf("%s", maze.str);
+	fprintMaze(stdout, &maze);
 }
@@ -4,224 +4,122 @@
 
 #include "MazeTools.h"
 #include "aStar.h"
-
-typedef struct {
-    Point_t self;
-    Point_t parent;
-	uint64_t startDistance;
-	uint64_t stopDistance;
-} node_t;
-
-typedef struct {
-    node_t *nodes;
-    size_t sz;
-    size_t count;
-} queue_t;
-
-static inline uint64_t hueristic(node_t node) {
-	return node.startDistance + node.stopDistance;
-}
-
-static queue_t initQueue(size_t sz) {
-    queue_t queue = {.nodes = NULL, .sz = sz, .count = 0};
-
-    queue.nodes = malloc(sizeof(*queue.nodes) * queue.sz);
-
-    return queue;
-}
-
-static void enqueue(queue_t *queue, node_t el) {
-	size_t i = 0;
-
-    if (queue->sz == 0) {
-        *queue = initQueue(100);
-    }
-
-    if (queue->count == queue->sz) {
-        queue->sz *= 2;
-
-        queue->nodes = realloc(queue->nodes, sizeof(*queue->nodes) * queue->sz);
-    }
-
-	for (i = 0; i < queue->count; i++) {
-		if (hueristic(el) < hueristic(queue->nodes[i])) {
-			break;
-		}
-	}
-
-	for (size_t j = queue->count; j > i; j--) {
-		queue->nodes[j] = queue->nodes[j - 1];
-	}
-
-	queue->nodes[i] = el;
-	queue->count++;
-}
-
-static node_t dequeue(queue_t *queue) {
-	Point_t badPoint = {UINT_MAX, UINT_MAX};
-	node_t node = {badPoint, badPoint};
-
-    if (queue->count > 0) {
-		node = queue->nodes[0];
-		queue->count--;
-		for (size_t i = 0; i < queue->count; i++) {
-			queue->nodes[i] = queue->nodes[i + 1];
-		}
-    }
-
-	return node;
-}
-
-static void freeQueue(queue_t *queue) {
-    free(queue->nodes);
-    queue->sz = 0;
-    queue->count = 0;
-}
-
-bool aStarSolve(Maze_t *maze, Point_t start, Point_t stop) {
-	size_t dirSz = 0;
-	size_t index;
-	size_t sz = maze->width * maze->height;
-	uint64_t weights[sz];
-    queue_t queue = initQueue(100);
-    node_t node = {start, start, 0, manhattenDistance(start, stop)};
-	node_t map[sz];
-	node_t tmpNode;
+#include "priorityQueue.h"
+#include "solverGrid.h"
+#include "solverWorkspace.h"
+#include "stepObserver.h"
+
+OBSERVED_INLINE bool solve(SolverGrid_t grid, Point_t start, Point_t stop,
+                           SolverWorkspace_t *workspace,
+                           const StepObserver_t *observer) {
+	Maze_t *maze = grid.maze;
+	IndexedHeap_t *queue = &workspace->heap;
+	DirectionMap_t *parents;
+	size_t startIndex = pointToIndex(start, grid.width);
+	size_t stopIndex = pointToIndex(stop, grid.width);
+	uint64_t distance;
+	Point_t point, newPoint;
 	Direction_t dir[4];
+	size_t dirSz = 0;
+	size_t index, newIndex, pos;
 	bool found = false;
 
-	for (size_t i = 0; i < sz; i++) {
-		weights[i] = SIZE_MAX;
+	resetSolverWorkspace(workspace, grid.width * grid.height);
+	if (!grid.packed) {
+		// the final step leaves a fresh string behind
+		invalidateMazeString(maze);
 	}
+	parents = &workspace->parents;
 
-	weights[pointToIndex(start, maze->width)] = hueristic(node);
-
-    enqueue(&queue, node);
-
-	while (queue.count > 0 && !found) {
-		node = dequeue(&queue);
-		index = pointToIndex(node.self, maze->width);
-
-		maze->cells[index].visited = 1;
-		map[index] = node;
-
-		if (pointEqual(node.self, stop)) {
-			found = true;
-		} else {
-			dirSz = getValidTravelDirections(node.self, *maze, dir);
+	observeFrame(observer, maze, renderPlain);
 
-			tmpNode.parent = node.self;
-			tmpNode.startDistance = node.startDistance + 1;
-			for (size_t i = 0; i < dirSz; i++) {
-				tmpNode.self = pointShift(node.self, dir[i]);
-				tmpNode.stopDistance = manhattenDistance(tmpNode.self, stop);
-				index = pointToIndex(tmpNode.self, maze->width);
-				if (!maze->cells[index].visited || hueristic(tmpNode) < weights[index]) {
-					enqueue(&queue, tmpNode);
-					weights[index] = hueristic(tmpNode);
-				}
-			}
-		}
+	workspaceSetDistance(workspace, startIndex, 0);
+	indexedHeapPush(queue, startIndex, manhattenDistance(start, stop));
+	if (observer) {
+		gridSetQueued(&grid, gridPos(&grid, start, startIndex), true);
+		observeCell(observer, maze, startIndex);
 	}
 
-	if (found) {
-		// draw path
-		while (!pointEqual(node.self, node.parent)) {
-			maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-			node = map[pointToIndex(node.parent, maze->width)];
-		}
-		// include start
-		maze->cells[pointToIndex(node.self, maze->width)].path = 1;
+	while (queue->count > 0 && !found) {
+		index = indexedHeapPop(queue, NULL);
+		point = indexToPoint(index, grid.width);
+		pos = gridPos(&grid, point, index);
 
-		if (maze->str) {
-			free(maze->str);
+		gridSetVisited(&grid, pos);
+		if (observer) {
+			gridSetQueued(&grid, pos, false);
+			observeCell(observer, maze, index);
 		}
-		maze->str = graphToString(maze->cells, maze->width, maze->height);
-	}
-
-    freeQueue(&queue);
-
-    return found;
-}
-
-bool aStarSolveWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                                FILE *restrict stream) {
-	size_t dirSz = 0;
-	size_t index;
-	size_t sz = maze->width * maze->height;
-	uint64_t weights[sz];
-    queue_t queue = initQueue(100);
-    node_t node = {start, start, 0, manhattenDistance(start, stop)};
-	node_t map[sz];
-	node_t tmpNode;
-	Direction_t dir[4];
-	bool found = false;
 
-	for (size_t i = 0; i < sz; i++) {
-		weights[i] = SIZE_MAX;
-	}
-
-	weights[pointToIndex(start, maze->width)] = 0;
-
-	fprintStep(stream, maze);
-
-    enqueue(&queue, node);
-	maze->cells[pointToIndex(node.self, maze->width)].queued = 1;
-
-	while (queue.count > 0 && !found) {
-		node = dequeue(&queue);
-		index = pointToIndex(node.self, maze->width);
-
-		maze->cells[index].visited = 1;
-		maze->cells[index].queued = 0;
-		map[index] = node;
-
-		if (pointEqual(node.self, stop)) {
+		if (index == stopIndex) {
 			found = true;
 		} else {
-			dirSz = getValidTravelDirections(node.self, *maze, dir);
+			dirSz = gridTravelDirections(&grid, point, dir);
 
-			tmpNode.parent = node.self;
-			tmpNode.startDistance = node.startDistance + 1;
+			distance = workspaceDistance(workspace, index) + 1;
 			for (size_t i = 0; i < dirSz; i++) {
-				tmpNode.self = pointShift(node.self, dir[i]);
-				tmpNode.stopDistance = manhattenDistance(tmpNode.self, stop);
-				index = pointToIndex(tmpNode.self, maze->width);
-				if (!maze->cells[index].visited || hueristic(tmpNode) < weights[index]) {
-					enqueue(&queue, tmpNode);
-					maze->cells[index].queued = 1;
-					weights[index] = tmpNode.startDistance;
+				newPoint = pointShift(point, dir[i]);
+				newIndex = pointToIndex(newPoint, grid.width);
+				pos = gridPos(&grid, newPoint, newIndex);
+				// visited cells are closed; queued cells get their key lowered
+				if (!gridVisited(&grid, pos) &&
+				    distance < workspaceDistance(workspace, newIndex)) {
+					indexedHeapPush(queue, newIndex,
+					                distance + manhattenDistance(newPoint, stop));
+					if (observer) {
+						gridSetQueued(&grid, pos, true);
+						observeCell(observer, maze, newIndex);
+					}
+					workspaceSetDistance(workspace, newIndex, distance);
+					directionMapSet(parents, newIndex, oppositeDirection(dir[i]));
 				}
 			}
-			fprintStep(stream, maze);
+			observeFrame(observer, maze, renderPlain);
 		}
 	}
 
-	for (size_t i = 0; i < maze->width * maze->height; i++) {
-		maze->cells[i].queued = 0;
+	if (observer) {
+		// only the cells still in the heap are marked
+		for (size_t i = 0; i < queue->count; i++) {
+			index = queue->nodes[i].index;
+			point = indexToPoint(index, grid.width);
+			gridSetQueued(&grid, gridPos(&grid, point, index), false);
+			observeCell(observer, maze, index);
+		}
 	}
 
 	if (found) {
 		// draw path
-		while (!pointEqual(node.self, node.parent)) {
-			maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-			node = map[pointToIndex(node.parent, maze->width)];
-			fprintStep(stream, maze);
+		point = stop;
+		for (index = stopIndex; index != startIndex;
+		     index = pointToIndex(point, grid.width)) {
+			gridSetPath(&grid, gridPos(&grid, point, index));
+			observeCell(observer, maze, index);
+			point = pointShift(point, directionMapGet(parents, index));
+			observeFrame(observer, maze, renderPlain);
 		}
 		// include start
-		maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-
-		if (maze->str) {
-			free(maze->str);
-		}
+		gridSetPath(&grid, gridPos(&grid, start, startIndex));
+		observeCell(observer, maze, startIndex);
 
-		maze->str = graphToString(maze->cells, maze->width, maze->height);
-		fputs(maze->str, stream);
+		observeDone(observer, maze);
 	}
 
-    freeQueue(&queue);
-
     return found;
 }
 
+bool aStarSolve(Maze_t *maze, Point_t start, Point_t stop,
+                SolverWorkspace_t *workspace) {
+	return solve(mazeSolverGrid(maze), start, stop, workspace, NULL);
+}
+
+bool aStarSolveObserved(Maze_t *maze, Point_t start, Point_t stop,
+                        SolverWorkspace_t *workspace,
+                        const StepObserver_t *observer) {
+	return solve(mazeSolverGrid(maze), start, stop, workspace, observer);
+}
 
+bool aStarSolveBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                    SolverWorkspace_t *workspace) {
+	return solve(bitsSolverGrid(bits), start, stop, workspace, NULL);
+}
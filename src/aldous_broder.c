@@ -1,28 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "MazeTools.h"
 #include "aldous_broder.h"
+#include "stepObserver.h"
 
-void aldousBroder(Maze_t *maze) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
 	Point_t point;
 	size_t sz = maze->width * maze->height;
 	size_t cellsNotVisitedCount = sz;
 	size_t index;
 
-	srand(time(NULL));
-
-	point.x = rand() % maze->width;
-	point.y = rand() % maze->height;
+	point.x = mazeRngBelow(rng, maze->width);
+	point.y = mazeRngBelow(rng, maze->height);
 
 	index = pointToIndex(point, maze->width);
 
 	maze->cells[index].visited = 1;
+	if (observer) {
+		maze->cells[index].observing = 1;
+		observeCell(observer, maze, index);
+		observeFrame(observer, maze, renderIgnoreVisited);
+	}
 	cellsNotVisitedCount--;
 
 	while (cellsNotVisitedCount > 0) {
-		Direction_t dir = getRandomDirection(point, *maze);
+		Direction_t dir = getRandomDirection(point, *maze, rng);
 		Point_t newPoint = pointShift(point, dir);
 		size_t newIndex = pointToIndex(newPoint, maze->width);
 
@@ -31,67 +35,39 @@ void aldousBroder(Maze_t *maze) {
 			maze->cells[newIndex].visited = 1;
 			cellsNotVisitedCount--;
 		}
+		if (observer) {
+			maze->cells[index].observing = 0;
+			maze->cells[newIndex].observing = 1;
+			observeCell(observer, maze, index);
+			observeCell(observer, maze, newIndex);
+			observeFrame(observer, maze, renderIgnoreVisited);
+		}
 
 		index = newIndex;
 		point = newPoint;
 	}
+	if (observer) {
+		maze->cells[index].observing = 0;
+		observeCell(observer, maze, index);
+	}
 
 	for (size_t i = 0; i < sz; i++) {
 		maze->cells[i].visited = 0;
+		observeCell(observer, maze, i);
 	}
 
     // assign start and stop location
-	assignRandomStartAndStop(maze);
+	assignRandomStartAndStopObserved(maze, rng, observer);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    // write the finished maze
+    observeDone(observer, maze);
 }
 
-void aldousBroderWithSteps(Maze_t *maze, FILE *restrict stream) {
-	Point_t point;
-	size_t sz = maze->width * maze->height;
-	size_t cellsNotVisitedCount = sz;
-	size_t index;
-
-	srand(time(NULL));
-
-	point.x = rand() % maze->width;
-	point.y = rand() % maze->height;
-
-	index = pointToIndex(point, maze->width);
-
-	maze->cells[index].visited = 1;
-	maze->cells[index].observing = 1;
-	fprintStepIgnoreVisted(stream, maze);
-	cellsNotVisitedCount--;
-
-	while (cellsNotVisitedCount > 0) {
-		Direction_t dir = getRandomDirection(point, *maze);
-		Point_t newPoint = pointShift(point, dir);
-		size_t newIndex = pointToIndex(newPoint, maze->width);
-
-		if (!maze->cells[newIndex].visited) {
-			mazeConnectCells(maze, index, newIndex, dir);
-			maze->cells[newIndex].visited = 1;
-			cellsNotVisitedCount--;
-		}
-		maze->cells[index].observing = 0;
-		maze->cells[newIndex].observing = 1;
-		fprintStepIgnoreVisted(stream, maze);
-
-		index = newIndex;
-		point = newPoint;
-	}
-	maze->cells[index].observing = 0;
-
-	for (size_t i = 0; i < sz; i++) {
-		maze->cells[i].visited = 0;
-	}
-
-    // assign start and stop location
-	assignRandomStartAndStopWithSteps(maze, stream);
+void aldousBroder(Maze_t *maze, MazeRng_t *rng) {
+	generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void aldousBroderObserved(Maze_t *maze, MazeRng_t *rng,
+                          const StepObserver_t *observer) {
+	generate(maze, rng, observer);
 }
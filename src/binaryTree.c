@@ -1,247 +1,96 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "MazeTools.h"
 #include "binaryTree.h"
-
-static void binaryTreeSW(Maze_t *maze) {
+#include "mazeBits.h"
+#include "stepObserver.h"
+
+OBSERVED_INLINE void generate(Maze_t *maze, binaryTreeBiases_t bias,
+                              MazeRng_t *rng, const StepObserver_t *observer) {
+    Direction_t horizontal =
+        bias == northEastTree || bias == southEastTree ? right : left;
+    Direction_t vertical =
+        bias == northEastTree || bias == northWestTree ? down : up;
+    bool blockedHorizontal, blockedVertical;
+    Direction_t dir;
     Point_t point;
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y == 0) {      // can't go up
-                if (point.x != 0) {  // can't go left
-                    mazeBreakWall(maze, point, left);
-                }
-            } else if (point.x == 0) {  // can't go left
-                mazeBreakWall(maze, point, up);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, left);
-                } else {
-                    mazeBreakWall(maze, point, up);
-                }
-            }
-        }
-    }
-}
-
-static void binaryTreeSE(Maze_t *maze) {
-    Point_t point;
+    observeFrame(observer, maze, renderPlain);
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
+    for (point.y = 0; bias != INVALID_BIAS && point.y < maze->height; point.y++) {
+        blockedVertical =
+            vertical == up ? point.y == 0 : point.y + 1 == maze->height;
         for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y == 0) {                    // can't go up
-                if (point.x + 1 != maze->width) {  // can't go right
-                    mazeBreakWall(maze, point, right);
-                }
-            } else if (point.x + 1 == maze->width) {  // can't go right
-                mazeBreakWall(maze, point, up);
+            blockedHorizontal =
+                horizontal == left ? point.x == 0 : point.x + 1 == maze->width;
+            if (blockedVertical) {
+                dir = horizontal;
+            } else if (blockedHorizontal) {
+                dir = vertical;
+            } else if (mazeRngCoin(rng)) {
+                dir = horizontal;
             } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-                } else {
-                    mazeBreakWall(maze, point, up);
-                }
+                dir = vertical;
             }
-        }
-    }
-}
-
-static void binaryTreeNW(Maze_t *maze) {
-    Point_t point;
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y + 1 == maze->height) {     // can't go down
-                if (point.x != 0) {  // can't go left
-                    mazeBreakWall(maze, point, left);
-                }
-            } else if (point.x == 0) {  // can't go left
-                mazeBreakWall(maze, point, down);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, left);
-                } else {
-                    mazeBreakWall(maze, point, down);
-                }
+            // the root of the tree has nowhere to go
+            if (!blockedVertical || !blockedHorizontal) {
+                mazeBreakWall(maze, point, dir);
+                observeWall(observer, maze, point, dir);
             }
+            observeFrame(observer, maze, renderPlain);
         }
     }
-}
 
-static void binaryTreeNE(Maze_t *maze) {
-    Point_t point;
+    // assign start and stop location
+    assignRandomStartAndStopObserved(maze, rng, observer);
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y + 1 == maze->height) {     // can't go down
-                if (point.x + 1 != maze->width) {  // can't go right
-                    mazeBreakWall(maze, point, right);
-                }
-            } else if (point.x + 1 == maze->width) {  // can't go right
-                mazeBreakWall(maze, point, down);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-                } else {
-                    mazeBreakWall(maze, point, down);
-                }
-            }
-        }
-    }
+    // write the finished maze
+    observeDone(observer, maze);
 }
 
-static void binaryTreeStepSW(Maze_t *maze, FILE *restrict stream) {
-    Point_t point;
-
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y == 0) {      // can't go up
-                if (point.x != 0) {  // can't go left
-                    mazeBreakWall(maze, point, left);
-                }
-            } else if (point.x == 0) {  // can't go left
-                mazeBreakWall(maze, point, up);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, left);
-                } else {
-                    mazeBreakWall(maze, point, up);
-                }
-            }
-			fprintStep(stream, maze);
-        }
-    }
+void binaryTreeGen(Maze_t *maze, binaryTreeBiases_t bias, MazeRng_t *rng) {
+    generate(maze, bias, rng, NULL);
 }
 
-static void binaryTreeStepSE(Maze_t *maze, FILE *restrict stream) {
-    Point_t point;
-
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y == 0) {                    // can't go up
-                if (point.x + 1 != maze->width) {  // can't go right
-                    mazeBreakWall(maze, point, right);
-                }
-            } else if (point.x + 1 == maze->width) {  // can't go right
-                mazeBreakWall(maze, point, up);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-                } else {
-                    mazeBreakWall(maze, point, up);
-                }
-            }
-			fprintStep(stream, maze);
-        }
-    }
-}
-
-static void binaryTreeStepNW(Maze_t *maze, FILE *restrict stream) {
-    Point_t point;
-
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y + 1 == maze->height) {     // can't go down
-                if (point.x != 0) {  // can't go left
-                    mazeBreakWall(maze, point, left);
-                }
-            } else if (point.x == 0) {  // can't go left
-                mazeBreakWall(maze, point, down);
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, left);
-                } else {
-                    mazeBreakWall(maze, point, down);
-                }
-            }
-			fprintStep(stream, maze);
-        }
-    }
+void binaryTreeGenObserved(Maze_t *maze, binaryTreeBiases_t bias,
+                           MazeRng_t *rng, const StepObserver_t *observer) {
+    generate(maze, bias, rng, observer);
 }
 
-static void binaryTreeStepNE(Maze_t *maze, FILE *restrict stream) {
+void binaryTreeGenBits(MazeBits_t *bits, binaryTreeBiases_t bias,
+                       MazeRng_t *rng) {
+    Direction_t horizontal =
+        bias == northEastTree || bias == southEastTree ? right : left;
+    Direction_t vertical =
+        bias == northEastTree || bias == northWestTree ? down : up;
+    bool blockedHorizontal, blockedVertical;
     Point_t point;
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            if (point.y + 1 == maze->height) {     // can't go down
-                if (point.x + 1 != maze->width) {  // can't go right
-                    mazeBreakWall(maze, point, right);
-                }
-            } else if (point.x + 1 == maze->width) {  // can't go right
-                mazeBreakWall(maze, point, down);
+    for (point.y = 0; bias != INVALID_BIAS && point.y < bits->height; point.y++) {
+        blockedVertical =
+            vertical == up ? point.y == 0 : point.y + 1 == bits->height;
+        for (point.x = 0; point.x < bits->width; point.x++) {
+            blockedHorizontal =
+                horizontal == left ? point.x == 0 : point.x + 1 == bits->width;
+            if (blockedVertical) {
+                if (!blockedHorizontal) {
+                    mazeBitsBreakWall(bits, point, horizontal);
+                }
+            } else if (blockedHorizontal) {
+                mazeBitsBreakWall(bits, point, vertical);
+            } else if (mazeRngCoin(rng)) {
+                mazeBitsBreakWall(bits, point, horizontal);
             } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-                } else {
-                    mazeBreakWall(maze, point, down);
-                }
+                mazeBitsBreakWall(bits, point, vertical);
             }
-			fprintStep(stream, maze);
         }
     }
-}
-
-void binaryTreeGen(Maze_t *maze, binaryTreeBiases_t bias) {
-    srand(time(NULL));
-
-    switch (bias) {
-        case northEastTree:
-            binaryTreeNE(maze);
-            break;
-        case northWestTree:
-            binaryTreeNW(maze);
-            break;
-        case southEastTree:
-            binaryTreeSE(maze);
-            break;
-        case southWestTree:
-            binaryTreeSW(maze);
-            break;
-        case INVALID_BIAS:
-            break;
-    }
 
     // assign start and stop location
-    assignRandomStartAndStop(maze);
-
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-}
-
-void binaryTreeGenWithSteps(Maze_t *maze, binaryTreeBiases_t bias,
-                            FILE *restrict stream) {
-    srand(time(NULL));
-
-	fprintStep(stream, maze);
-
-    switch (bias) {
-        case northEastTree:
-            binaryTreeStepNE(maze, stream);
-            break;
-        case northWestTree:
-            binaryTreeStepNW(maze, stream);
-            break;
-        case southEastTree:
-            binaryTreeStepSE(maze, stream);
-            break;
-        case southWestTree:
-            binaryTreeStepSW(maze, stream);
-            break;
-        case INVALID_BIAS:
-            break;
-    }
-
-    // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
-
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+    assignRandomStartAndStopBits(bits, rng);
 }
 
 binaryTreeBiases_t strToTreeBias(const char *str) {
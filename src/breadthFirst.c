@@ -4,181 +4,107 @@
 
 #include "MazeTools.h"
 #include "breadthFirst.h"
-
-typedef struct {
-    Point_t self;
-    Point_t parent;
-} node_t;
-
-typedef struct {
-    node_t *nodes;
-    size_t sz;
-    size_t count;
-} queue_t;
-
-static queue_t initQueue(size_t sz) {
-    queue_t queue = {.nodes = NULL, .sz = sz, .count = 0};
-
-    queue.nodes = malloc(sizeof(*queue.nodes) * queue.sz);
-
-    return queue;
-}
-
-static void enqueue(queue_t *queue, node_t el) {
-    if (queue->sz == 0) {
-        *queue = initQueue(100);
-    }
-
-    if (queue->count == queue->sz) {
-        queue->sz *= 2;
-
-        queue->nodes = realloc(queue->nodes, sizeof(*queue->nodes) * queue->sz);
-    }
-
-	queue->nodes[queue->count++] = el;
-}
-
-static node_t dequeue(queue_t *queue) {
-	Point_t badPoint = {UINT_MAX, UINT_MAX};
-	node_t node = {badPoint, badPoint};
-
-    if (queue->count > 0) {
-		node = queue->nodes[0];
-		queue->count--;
-		for (size_t i = 0; i < queue->count; i++) {
-			queue->nodes[i] = queue->nodes[i + 1];
-		}
-    }
-
-	return node;
-}
-
-static void freeQueue(queue_t *queue) {
-    free(queue->nodes);
-    queue->sz = 0;
-    queue->count = 0;
-}
-
-bool breadthFirstSolve(Maze_t *maze, Point_t start, Point_t stop) {
-    queue_t queue = initQueue(100);
-    node_t node = {start, start};
-	node_t map[maze->width * maze->height];
-	node_t tmpNode;
+#include "priorityQueue.h"
+#include "solverGrid.h"
+#include "solverWorkspace.h"
+#include "stepObserver.h"
+
+OBSERVED_INLINE bool solve(SolverGrid_t grid, Point_t start, Point_t stop,
+                           SolverWorkspace_t *workspace,
+                           const StepObserver_t *observer) {
+	Maze_t *maze = grid.maze;
+	RingQueue_t *queue = &workspace->ring;
+	DirectionMap_t *parents;
+	size_t startIndex = pointToIndex(start, grid.width);
+	size_t stopIndex = pointToIndex(stop, grid.width);
+	Point_t point, newPoint;
 	Direction_t dir[4];
 	size_t dirSz = 0;
-	size_t index;
+	size_t index, newIndex, pos;
 	bool found = false;
 
-    enqueue(&queue, node);
-
-	while (queue.count > 0 && !found) {
-		node = dequeue(&queue);
-		index = pointToIndex(node.self, maze->width);
-
-		maze->cells[index].visited = 1;
-		map[index] = node;
-
-		if (pointEqual(node.self, stop)) {
-			found = true;
-		} else {
-			dirSz = getValidTravelDirections(node.self, *maze, dir);
-
-			tmpNode.parent = node.self;
-			for (size_t i = 0; i < dirSz; i++) {
-				tmpNode.self = pointShift(node.self, dir[i]);
-				index = pointToIndex(tmpNode.self, maze->width);
-				if (!maze->cells[index].visited) {
-					enqueue(&queue, tmpNode);
-				}
-			}
-		}
-	}
-
-	if (found) {
-		// draw path
-		while (!pointEqual(node.self, node.parent)) {
-			maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-			node = map[pointToIndex(node.parent, maze->width)];
-		}
-		// include start
-		maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-
-		if (maze->str) {
-			free(maze->str);
-		}
-		maze->str = graphToString(maze->cells, maze->width, maze->height);
+	resetSolverWorkspace(workspace, grid.width * grid.height);
+	if (!grid.packed) {
+		// the final step leaves a fresh string behind
+		invalidateMazeString(maze);
 	}
+	parents = &workspace->parents;
 
-    freeQueue(&queue);
+	observeFrame(observer, maze, renderPlain);
 
-    return found;
-}
+	ringQueuePush(queue, startIndex);
+	gridSetQueued(&grid, gridPos(&grid, start, startIndex), true);
+	observeCell(observer, maze, startIndex);
 
-bool breadthFirstSolveWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                                FILE *restrict stream) {
-    queue_t queue = initQueue(100);
-    node_t node = {start, start};
-	node_t map[maze->width * maze->height];
-	node_t tmpNode;
-	Direction_t dir[4];
-	size_t dirSz = 0;
-	size_t index;
-	bool found = false;
-
-	fprintStep(stream, maze);
-
-    enqueue(&queue, node);
-	maze->cells[pointToIndex(node.self, maze->width)].queued = 1;
-
-	while (queue.count > 0 && !found) {
-		node = dequeue(&queue);
-		index = pointToIndex(node.self, maze->width);
+	while (queue->count > 0 && !found) {
+		index = ringQueuePop(queue);
+		point = indexToPoint(index, grid.width);
+		pos = gridPos(&grid, point, index);
 
-		maze->cells[index].visited = 1;
-		maze->cells[index].queued = 0;
-		map[index] = node;
+		gridSetVisited(&grid, pos);
+		gridSetQueued(&grid, pos, false);
+		observeCell(observer, maze, index);
 
-		if (pointEqual(node.self, stop)) {
+		if (index == stopIndex) {
 			found = true;
 		} else {
-			dirSz = getValidTravelDirections(node.self, *maze, dir);
+			dirSz = gridTravelDirections(&grid, point, dir);
 
-			tmpNode.parent = node.self;
 			for (size_t i = 0; i < dirSz; i++) {
-				tmpNode.self = pointShift(node.self, dir[i]);
-				index = pointToIndex(tmpNode.self, maze->width);
-				if (!maze->cells[index].visited) {
-					enqueue(&queue, tmpNode);
-					maze->cells[index].queued = 1;
+				newPoint = pointShift(point, dir[i]);
+				newIndex = pointToIndex(newPoint, grid.width);
+				pos = gridPos(&grid, newPoint, newIndex);
+				if (!gridVisited(&grid, pos) && !gridQueued(&grid, pos)) {
+					ringQueuePush(queue, newIndex);
+					gridSetQueued(&grid, pos, true);
+					observeCell(observer, maze, newIndex);
+					directionMapSet(parents, newIndex, oppositeDirection(dir[i]));
 				}
 			}
-			fprintStep(stream, maze);
+			observeFrame(observer, maze, renderPlain);
 		}
 	}
 
-	for (size_t i = 0; i < maze->width * maze->height; i++) {
-		maze->cells[i].queued = 0;
+	// only the cells still in the queue are marked
+	while (queue->count > 0) {
+		index = ringQueuePop(queue);
+		point = indexToPoint(index, grid.width);
+		gridSetQueued(&grid, gridPos(&grid, point, index), false);
+		observeCell(observer, maze, index);
 	}
 
 	if (found) {
 		// draw path
-		while (!pointEqual(node.self, node.parent)) {
-			maze->cells[pointToIndex(node.self, maze->width)].path = 1;
-			node = map[pointToIndex(node.parent, maze->width)];
-			fprintStep(stream, maze);
+		point = stop;
+		for (index = stopIndex; index != startIndex;
+		     index = pointToIndex(point, grid.width)) {
+			gridSetPath(&grid, gridPos(&grid, point, index));
+			observeCell(observer, maze, index);
+			point = pointShift(point, directionMapGet(parents, index));
+			observeFrame(observer, maze, renderPlain);
 		}
 		// include start
-		maze->cells[pointToIndex(node.self, maze->width)].path = 1;
+		gridSetPath(&grid, gridPos(&grid, start, startIndex));
+		observeCell(observer, maze, startIndex);
 
-		if (maze->str) {
-			free(maze->str);
-		}
-
-		maze->str = graphToString(maze->cells, maze->width, maze->height);
-		fputs(maze->str, stream);
+		observeDone(observer, maze);
 	}
 
-    freeQueue(&queue);
-
     return found;
 }
+
+bool breadthFirstSolve(Maze_t *maze, Point_t start, Point_t stop,
+                       SolverWorkspace_t *workspace) {
+	return solve(mazeSolverGrid(maze), start, stop, workspace, NULL);
+}
+
+bool breadthFirstSolveObserved(Maze_t *maze, Point_t start, Point_t stop,
+                               SolverWorkspace_t *workspace,
+                               const StepObserver_t *observer) {
+	return solve(mazeSolverGrid(maze), start, stop, workspace, observer);
+}
+
+bool breadthFirstSolveBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                           SolverWorkspace_t *workspace) {
+	return solve(bitsSolverGrid(bits), start, stop, workspace, NULL);
+}
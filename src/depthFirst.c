@@ -2,104 +2,104 @@
 
 #include "MazeTools.h"
 #include "depthFirst.h"
+#include "packedDirections.h"
+#include "solverGrid.h"
+#include "solverWorkspace.h"
+#include "stepObserver.h"
+
+// Directions are tried in enum order (up, down, left, right), which is the
+// order the recursive solver used.
+OBSERVED_INLINE bool canEnter(const SolverGrid_t *grid, Point_t point,
+                              size_t pos, Direction_t dir) {
+    return gridIsOpen(grid, point, pos, dir) &&
+           !gridVisited(grid, gridNeighbourPos(grid, pos, dir));
+}
 
-bool depthFirstSolve(Maze_t *maze, Point_t start, Point_t stop) {
-    size_t i = pointToIndex(start, maze->width);
-
-    maze->cells[i].visited = 1;
-
-    if (start.x == stop.x && start.y == stop.y) {
-        maze->cells[i].path = 1;
-        return true;
+OBSERVED_INLINE bool solve(SolverGrid_t grid, Point_t start, Point_t stop,
+                           SolverWorkspace_t *workspace,
+                           const StepObserver_t *observer) {
+    Maze_t *maze = grid.maze;
+    DirectionStack_t *stack = &workspace->stack;
+    Point_t point = start;
+    size_t i = pointToIndex(point, grid.width);
+    size_t pos = gridPos(&grid, point, i);
+    unsigned next = up;
+    bool found = false;
+
+    resetSolverWorkspace(workspace, grid.width * grid.height);
+    if (!grid.packed) {
+        // the final step leaves a fresh string behind
+        invalidateMazeString(maze);
     }
 
-    if (start.y > 0 && maze->cells[i].top == 0 &&
-        maze->cells[i - maze->width].visited == 0) {
-        if (depthFirstSolve(maze, (Point_t){start.x, start.y - 1}, stop)) {
-            maze->cells[i].path = 1;
-            return true;
-        }
-    }
+    gridSetVisited(&grid, pos);
+    observeCell(observer, maze, i);
+    observeFrame(observer, maze, renderPlain);
 
-    if (start.y < maze->height - 1 && maze->cells[i].bottom == 0 &&
-        maze->cells[i + maze->width].visited == 0) {
-        if (depthFirstSolve(maze, (Point_t){start.x, start.y + 1}, stop)) {
-            maze->cells[i].path = 1;
-            return true;
+    while (!found) {
+        if (pointEqual(point, stop)) {
+            found = true;
+            break;
         }
-    }
 
-    if (start.x > 0 && maze->cells[i].left == 0 &&
-        maze->cells[i - 1].visited == 0) {
-        if (depthFirstSolve(maze, (Point_t){start.x - 1, start.y}, stop)) {
-            maze->cells[i].path = 1;
-            return true;
+        while (next <= right && !canEnter(&grid, point, pos, next)) {
+            next++;
         }
-    }
 
-    if (start.x < maze->width - 1 && maze->cells[i].right == 0 &&
-        maze->cells[i + 1].visited == 0) {
-        if (depthFirstSolve(maze, (Point_t){start.x + 1, start.y}, stop)) {
-            maze->cells[i].path = 1;
-            return true;
+        if (next <= right) {
+            // descend
+            directionStackPush(stack, next);
+            point = pointShift(point, next);
+            i = pointToIndex(point, grid.width);
+            pos = gridPos(&grid, point, i);
+            gridSetVisited(&grid, pos);
+            observeCell(observer, maze, i);
+            observeFrame(observer, maze, renderPlain);
+            next = up;
+        } else if (stack->count > 0) {
+            // backtrack and try the parent's next direction
+            Direction_t dir = directionStackPop(stack);
+            point = pointShift(point, oppositeDirection(dir));
+            i = pointToIndex(point, grid.width);
+            pos = gridPos(&grid, point, i);
+            next = dir + 1;
+        } else {
+            break;
         }
     }
 
-    return false;
-}
-
-bool depthFirstSolveWithSteps(Maze_t *maze, Point_t start, Point_t stop,
-                              FILE *restrict stream) {
-    size_t i = pointToIndex(start, maze->width);
-
-    maze->cells[i].visited = 1;
-    fprintStep(stream, maze);
-
-    if (start.x == stop.x && start.y == stop.y) {
-        maze->cells[i].path = 1;
-        fprintStep(stream, maze);
-        return true;
-    }
-
-    if (start.y > 0 && maze->cells[i].top == 0 &&
-        maze->cells[i - maze->width].visited == 0) {
-        if (depthFirstSolveWithSteps(maze, (Point_t){start.x, start.y - 1},
-                                     stop, stream)) {
-            maze->cells[i].path = 1;
-            fprintStep(stream, maze);
-            return true;
+    if (found) {
+        // draw path from the stop back to the start
+        gridSetPath(&grid, pos);
+        observeCell(observer, maze, i);
+        observeFrame(observer, maze, renderPlain);
+        while (stack->count > 0) {
+            point = pointShift(point, oppositeDirection(directionStackPop(stack)));
+            i = pointToIndex(point, grid.width);
+            gridSetPath(&grid, gridPos(&grid, point, i));
+            observeCell(observer, maze, i);
+            observeFrame(observer, maze, renderPlain);
         }
     }
 
-    if (start.y < maze->height - 1 && maze->cells[i].bottom == 0 &&
-        maze->cells[i + maze->width].visited == 0) {
-        if (depthFirstSolveWithSteps(maze, (Point_t){start.x, start.y + 1},
-                                     stop, stream)) {
-            maze->cells[i].path = 1;
-            fprintStep(stream, maze);
-            return true;
-        }
-    }
+    // a dead end still shows how far the search got
+    observeDone(observer, maze);
 
-    if (start.x > 0 && maze->cells[i].left == 0 &&
-        maze->cells[i - 1].visited == 0) {
-        if (depthFirstSolveWithSteps(maze, (Point_t){start.x - 1, start.y},
-                                     stop, stream)) {
-            maze->cells[i].path = 1;
-            fprintStep(stream, maze);
-            return true;
-        }
-    }
+    return found;
+}
 
-    if (start.x < maze->width - 1 && maze->cells[i].right == 0 &&
-        maze->cells[i + 1].visited == 0) {
-        if (depthFirstSolveWithSteps(maze, (Point_t){start.x + 1, start.y},
-                                     stop, stream)) {
-            maze->cells[i].path = 1;
-            fprintStep(stream, maze);
-            return true;
-        }
-    }
+bool depthFirstSolve(Maze_t *maze, Point_t start, Point_t stop,
+                     SolverWorkspace_t *workspace) {
+    return solve(mazeSolverGrid(maze), start, stop, workspace, NULL);
+}
+
+bool depthFirstSolveObserved(Maze_t *maze, Point_t start, Point_t stop,
+                             SolverWorkspace_t *workspace,
+                             const StepObserver_t *observer) {
+    return solve(mazeSolverGrid(maze), start, stop, workspace, observer);
+}
 
-    return false;
+bool depthFirstSolveBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                         SolverWorkspace_t *workspace) {
+    return solve(bitsSolverGrid(bits), start, stop, workspace, NULL);
 }
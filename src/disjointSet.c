@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "disjointSet.h"
+
+DisjointSet_t createDisjointSet(size_t sz) {
+    DisjointSet_t set = {.parent = NULL, .size = NULL, .sz = sz};
+
+    if (sz > UINT32_MAX) {
+        fprintf(stderr, "A disjoint set can not hold more than %u indexes\n",
+                UINT32_MAX);
+        exit(EXIT_FAILURE);
+    }
+
+    set.parent = malloc(sizeof(*set.parent) * (sz ? sz : 1));
+    set.size = malloc(sizeof(*set.size) * (sz ? sz : 1));
+    if (set.parent == NULL || set.size == NULL) {
+        perror("Failed to allocate disjoint set");
+        exit(EXIT_FAILURE);
+    }
+
+    resetDisjointSet(&set);
+
+    return set;
+}
+
+void resetDisjointSet(DisjointSet_t *set) {
+    for (size_t i = 0; i < set->sz; i++) {
+        set->parent[i] = i;
+        set->size[i] = 1;
+    }
+}
+
+void freeDisjointSet(DisjointSet_t *set) {
+    free(set->parent);
+    free(set->size);
+    set->parent = NULL;
+    set->size = NULL;
+    set->sz = 0;
+}
@@ -1,214 +1,340 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
+#include <sys/types.h>
 
 #include "MazeTools.h"
+#include "disjointSet.h"
 #include "eller.h"
+#include "mazeBits.h"
+#include "mazeFile.h"
+#include "stepObserver.h"
+
+// marks a set that has not been seen in the current row
+#define NO_COLUMN UINT32_MAX
+
+// the rows of right and down walls a binary stream buffers before writing
+#define STREAM_CHUNK_WORDS 4096
+
+// The state of Eller's algorithm. A row is only ever joined to itself and the
+// row below, so the sets of two rows are all that is kept. Sets are named by
+// a column: the columns of the current row index a disjoint-set forest, and
+// below holds the set every cell of the next row starts in.
+typedef struct {
+    size_t width;
+    size_t stride;
+    DisjointSet_t sets;
+    uint32_t *below;
+    uint32_t *extended;
+    uint64_t *right;
+    uint64_t *down;
+} EllerRows_t;
+
+static EllerRows_t createEllerRows(size_t width) {
+    EllerRows_t rows;
+
+    // a set is named by its column, and one name is kept for no column
+    if (width >= NO_COLUMN) {
+        fprintf(stderr,
+                "Eller's algorithm can not generate rows wider than %u cells\n",
+                NO_COLUMN - 1);
+        exit(EXIT_FAILURE);
+    }
 
-static bool isLast(size_t sz, Tree_t *set[sz], size_t i) {
-    for (size_t j = i + 1; j < sz; j++) {
-        if (isSameTree(set[i], set[j])) {
-            return false;
-        }
+    rows.width = width;
+    rows.stride = (width + 63) / 64;
+    rows.sets = createDisjointSet(width);
+    rows.below = malloc(sizeof(*rows.below) * (width ? width : 1));
+    rows.extended = malloc(sizeof(*rows.extended) * (width ? width : 1));
+    rows.right = malloc(sizeof(*rows.right) * (rows.stride ? rows.stride : 1));
+    rows.down = malloc(sizeof(*rows.down) * (rows.stride ? rows.stride : 1));
+    if (rows.below == NULL || rows.extended == NULL || rows.right == NULL ||
+        rows.down == NULL) {
+        perror("Failed to allocate Eller rows");
+        exit(EXIT_FAILURE);
     }
 
-    return true;
+    return rows;
+}
+
+static void freeEllerRows(EllerRows_t *rows) {
+    freeDisjointSet(&rows->sets);
+    free(rows->below);
+    free(rows->extended);
+    free(rows->right);
+    free(rows->down);
+    rows->below = NULL;
+    rows->extended = NULL;
+    rows->right = NULL;
+    rows->down = NULL;
 }
 
-static bool isInArray(size_t val, size_t sz, int const array[sz]) {
-    for (size_t i = 0; i < sz; i++) {
-        if (val == array[i]) {
-            return true;
+// Joins neighbouring cells of the current row that are in different sets,
+// each with even odds. The last row joins all of them.
+static void joinRow(EllerRows_t *rows, MazeRng_t *rng, bool lastRow) {
+    memset(rows->right, 0xff, sizeof(*rows->right) * rows->stride);
+    memset(rows->down, 0xff, sizeof(*rows->down) * rows->stride);
+
+    for (size_t x = 0; x + 1 < rows->width; x++) {
+        if (!disjointSetSame(&rows->sets, x, x + 1) &&
+            (lastRow || mazeRngCoin(rng))) {
+            bitsClear(rows->right, x);
+            disjointSetUnion(&rows->sets, x, x + 1);
         }
     }
-
-    return false;
 }
 
-// only true if all branches (and parent) are NULL
-static inline bool isIsolated(Tree_t const *node) {
-    return !node->parent && !node->left && !node->right;
-}
+// Extends the sets of the current row down, then makes the next row current.
+// Going right to left, the first cell seen of a set is its last one, and
+// always extends so that no set is cut off; the others extend with even odds.
+static void extendRow(EllerRows_t *rows, MazeRng_t *rng) {
+    uint32_t *parent = rows->sets.parent;
+    uint32_t *size = rows->sets.size;
 
-void ellerGen(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t procCount = 0;
-    size_t i, newI;
-    Tree_t cells[sz];
-    Tree_t *sets[maze->width];
-    Point_t point = {0, 0};
-    Point_t newPoint;
-    int procSets[maze->width];
-
-    for (size_t i = 0; i < sz; i++) {
-        cells[i].val = i;
-        cells[i].left = NULL;
-        cells[i].right = NULL;
-        cells[i].parent = NULL;
+    for (size_t x = 0; x < rows->width; x++) {
+        rows->extended[x] = NO_COLUMN;
     }
 
-    // initialize the first row with unique sets
-    for (size_t i = 0; i < maze->width; i++) {
-        sets[i] = cells + i;
+    for (size_t col = rows->width; col-- > 0;) {
+        uint32_t set = disjointSetFind(&rows->sets, col);
+
+        if (rows->extended[set] == NO_COLUMN) {
+            rows->extended[set] = col;
+            rows->below[col] = col;
+            bitsClear(rows->down, col);
+        } else if (mazeRngCoin(rng)) {
+            rows->below[col] = rows->extended[set];
+            bitsClear(rows->down, col);
+        } else {
+            // a cell that did not extend down leaves a set of its own below
+            rows->below[col] = col;
+        }
     }
 
-    srand(time(NULL));
-
-    // process all but the last row
-    for (point.y = 0; point.y < maze->height - 1; point.y++) {
-		procCount = 0;
+    // The sets below are named by their last column, which extended and so
+    // is no other cell's name; every cell points straight at its set.
+    for (size_t x = 0; x < rows->width; x++) {
+        size[x] = 0;
+    }
+    for (size_t x = 0; x < rows->width; x++) {
+        parent[x] = rows->below[x];
+        size[rows->below[x]]++;
+    }
+}
 
-        // process row
-        for (point.x = 0; point.x < maze->width - 1; point.x++) {
-            if (!isSameTree(sets[point.x], sets[point.x + 1])) {
-                // randomly join
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-                    joinTrees(sets[point.x], sets[point.x + 1]);
-                }
-            }
-        }
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
+    EllerRows_t rows = createEllerRows(maze->width);
+    Point_t point = {0, 0};
 
-        // randomly connect verticals
-        for (ssize_t col = point.x; col >= 0; col--) {
-            Tree_t *tmp = sets[col];
-			point.x = col;
+    observeFrame(observer, maze, renderPlain);
 
-            newPoint = pointShift(point, down);
-            i = pointToIndex(point, maze->width);
-            newI = pointToIndex(newPoint, maze->width);
+    for (point.y = 0; point.y < maze->height; point.y++) {
+        bool lastRow = point.y + 1 == maze->height;
 
-            // isolated cells allways extend down
-            // If it's the last cell in a set and it hasn't extended,
-            // then extend it down
-            if (isIsolated(tmp) || (!isInArray(tmp->val, procCount, procSets) &&
-                                    isLast(maze->width, sets, col))) {
-                mazeBreakWall(maze, point, down);
-                joinTrees(cells + i, cells + newI);
-                procSets[procCount++] = tmp->val;
-                // non-isolated cells sometimes join
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, down);
-                    joinTrees(getHead(cells + i), cells + newI);
-                    procSets[procCount++] = tmp->val;
-                }
+        joinRow(&rows, rng, lastRow);
+        for (point.x = 0; point.x + 1 < maze->width; point.x++) {
+            if (!bitsTest(rows.right, point.x)) {
+                mazeBreakWall(maze, point, right);
+                observeWall(observer, maze, point, right);
+                observeFrame(observer, maze, renderPlain);
             }
         }
 
-        // move to next set
-        for (size_t i = 0; i < maze->width; i++) {
-            sets[i] = cells + i + (point.y + 1) * maze->width;
+        if (lastRow) {
+            break;
         }
-    }
 
-    // process the last row
-    for (point.x = 0; point.x < maze->width - 1; point.x++) {
-        if (!isSameTree(sets[point.x], sets[point.x + 1])) {
-            mazeBreakWall(maze, point, right);
-            joinTrees(sets[point.x], sets[point.x + 1]);
+        // the walls come down in the order they were drawn, right to left
+        extendRow(&rows, rng);
+        for (point.x = maze->width; point.x-- > 0;) {
+            if (!bitsTest(rows.down, point.x)) {
+                mazeBreakWall(maze, point, down);
+                observeWall(observer, maze, point, down);
+                observeFrame(observer, maze, renderPlain);
+            }
         }
     }
 
+    freeEllerRows(&rows);
+
     // assign start and stop location
-    assignRandomStartAndStop(maze);
+    assignRandomStartAndStopObserved(maze, rng, observer);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    // write the finished maze
+    observeDone(observer, maze);
 }
 
-void ellerGenWithSteps(Maze_t *maze, FILE *restrict stream) {
-    size_t sz = maze->width * maze->height;
-    size_t procCount = 0;
-    size_t i, newI;
-    Tree_t cells[sz];
-    Tree_t *sets[maze->width];
-    Point_t point = {0, 0};
-    Point_t newPoint;
-    int procSets[maze->width];
-
-    for (size_t i = 0; i < sz; i++) {
-        cells[i].val = i;
-        cells[i].left = NULL;
-        cells[i].right = NULL;
-        cells[i].parent = NULL;
-    }
+void ellerGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
+
+void ellerGenObserved(Maze_t *maze, MazeRng_t *rng,
+                      const StepObserver_t *observer) {
+    generate(maze, rng, observer);
+}
 
-    // initialize the first row with unique sets
-    for (size_t i = 0; i < maze->width; i++) {
-        sets[i] = cells + i;
+// Expands the walls of a finished row into cells for rendering.
+static void loadStreamRow(const EllerRows_t *rows, const uint64_t *above,
+                          uint32_t y, Point_t start, Point_t stop,
+                          Cell_t *row) {
+    Point_t point = {0, y};
+
+    for (point.x = 0; point.x < rows->width; point.x++) {
+        Cell_t *cell = &row[point.x];
+
+        *cell = (Cell_t){0};
+        cell->top = above == NULL || bitsTest(above, point.x);
+        cell->bottom = bitsTest(rows->down, point.x);
+        cell->left = point.x == 0 || bitsTest(rows->right, point.x - 1);
+        cell->right = bitsTest(rows->right, point.x);
+        cell->start = pointEqual(point, start);
+        cell->stop = pointEqual(point, stop);
     }
+}
 
-	fprintStep(stream, maze);
+static bool streamText(FILE *stream, size_t width, size_t height,
+                       MazeRng_t *rng, Point_t start, Point_t stop) {
+    size_t strWidth = width * 2 + 1 + 1;
+    EllerRows_t rows = createEllerRows(width);
+    uint64_t *above = malloc(sizeof(*above) * (rows.stride ? rows.stride : 1));
+    Cell_t *row = malloc(sizeof(*row) * (width ? width : 1));
+    char *band = malloc(sizeof(*band) * strWidth * 2);
+
+    if (above == NULL || row == NULL || band == NULL) {
+        perror("Failed to allocate Eller rows");
+        exit(EXIT_FAILURE);
+    }
 
-    srand(time(NULL));
+    for (size_t y = 0; y < height; y++) {
+        bool lastRow = y + 1 == height;
 
-    // process all but the last row
-    for (point.y = 0; point.y < maze->height - 1; point.y++) {
-		procCount = 0;
+        joinRow(&rows, rng, lastRow);
+        if (!lastRow) {
+            extendRow(&rows, rng);
+        }
 
-        // process row
-        for (point.x = 0; point.x < maze->width - 1; point.x++) {
-            if (!isSameTree(sets[point.x], sets[point.x + 1])) {
-                // randomly join
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, right);
-					fprintStep(stream, maze);
-                    joinTrees(sets[point.x], sets[point.x + 1]);
-                }
-            }
+        loadStreamRow(&rows, y ? above : NULL, y, start, stop, row);
+        if (y == 0) {
+            renderMazeTopLine(row, width, band);
+            fwrite(band, 1, strWidth, stream);
         }
 
-        // randomly connect verticals
-        for (ssize_t col = point.x; col >= 0; col--) {
-            Tree_t *tmp = sets[col];
-			point.x = col;
+        // the walls are consistent, so the row below is not needed to draw
+        renderMazeRowBand(row, NULL, width, band);
+        fwrite(band, 1, strWidth * 2, stream);
+
+        memcpy(above, rows.down, sizeof(*above) * rows.stride);
+    }
 
-            newPoint = pointShift(point, down);
-            i = pointToIndex(point, maze->width);
-            newI = pointToIndex(newPoint, maze->width);
+    freeEllerRows(&rows);
+    free(above);
+    free(row);
+    free(band);
 
-            // isolated cells allways extend down
-            // If it's the last cell in a set and it hasn't extended,
-            // then extend it down
-            if (isIsolated(tmp) || (!isInArray(tmp->val, procCount, procSets) &&
-                                    isLast(maze->width, sets, col))) {
-                mazeBreakWall(maze, point, down);
-				fprintStep(stream, maze);
-                joinTrees(cells + i, cells + newI);
-                procSets[procCount++] = tmp->val;
-                // non-isolated cells sometimes join
-            } else {
-                if (rand() % 2 == 0) {
-                    mazeBreakWall(maze, point, down);
-					fprintStep(stream, maze);
-                    joinTrees(getHead(cells + i), cells + newI);
-                    procSets[procCount++] = tmp->val;
-                }
-            }
-        }
+    return !ferror(stream);
+}
 
-        // move to next set
-        for (size_t i = 0; i < maze->width; i++) {
-            sets[i] = cells + i + (point.y + 1) * maze->width;
-        }
+// Writes rows [y, y + count) of the right and down planes of a .mzb file.
+static bool writePlaneRows(FILE *stream, off_t planes, size_t words,
+                           size_t stride, size_t y, size_t count,
+                           const uint64_t *right, const uint64_t *down) {
+    size_t n = count * stride;
+
+    return fseeko(stream, planes + sizeof(*right) * y * stride, SEEK_SET) ==
+               0 &&
+           fwrite(right, sizeof(*right), n, stream) == n &&
+           fseeko(stream, planes + sizeof(*down) * (words + y * stride),
+                  SEEK_SET) == 0 &&
+           fwrite(down, sizeof(*down), n, stream) == n;
+}
+
+static bool streamBinary(FILE *stream, size_t width, size_t height,
+                         MazeRng_t *rng, Point_t start, Point_t stop,
+                         uint64_t seed) {
+    EllerRows_t rows = createEllerRows(width);
+    size_t stride = rows.stride;
+    size_t words = stride * height;
+    size_t leftWords = (height + 63) / 64;
+    size_t chunkRows = stride && stride < STREAM_CHUNK_WORDS
+                           ? STREAM_CHUNK_WORDS / stride
+                           : 1;
+    uint64_t *right = malloc(sizeof(*right) * chunkRows * (stride ? stride : 1));
+    uint64_t *down = malloc(sizeof(*down) * chunkRows * (stride ? stride : 1));
+    uint64_t walls = UINT64_MAX;
+    MazeFileHeader_t header;
+    off_t planes;
+    size_t chunkY = 0;
+    bool ok = true;
+
+    if (right == NULL || down == NULL) {
+        perror("Failed to allocate Eller rows");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAZE_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = MAZE_FILE_BYTE_ORDER;
+    header.width = width;
+    header.height = height;
+    header.start = start;
+    header.stop = stop;
+    header.seed = seed;
+
+    // the right and down planes come first but are filled in as rows finish
+    planes = ftello(stream);
+    ok = planes >= 0 && fwrite(&header, sizeof(header), 1, stream) == 1 &&
+         fseeko(stream, (planes += sizeof(header)) + sizeof(walls) * 2 * words,
+                SEEK_SET) == 0;
+    for (size_t i = 0; ok && i < stride + leftWords; i++) {
+        ok = fwrite(&walls, sizeof(walls), 1, stream) == 1;
     }
 
-    // process the last row
-    for (point.x = 0; point.x < maze->width - 1; point.x++) {
-        if (!isSameTree(sets[point.x], sets[point.x + 1])) {
-            mazeBreakWall(maze, point, right);
-			fprintStep(stream, maze);
-            joinTrees(sets[point.x], sets[point.x + 1]);
+    for (size_t y = 0; ok && y < height; y++) {
+        bool lastRow = y + 1 == height;
+
+        joinRow(&rows, rng, lastRow);
+        if (!lastRow) {
+            extendRow(&rows, rng);
+        }
+
+        memcpy(right + (y - chunkY) * stride, rows.right,
+               sizeof(*right) * stride);
+        memcpy(down + (y - chunkY) * stride, rows.down,
+               sizeof(*down) * stride);
+
+        if (lastRow || y + 1 - chunkY == chunkRows) {
+            ok = writePlaneRows(stream, planes, words, stride, chunkY,
+                                y + 1 - chunkY, right, down);
+            chunkY = y + 1;
         }
     }
 
-    // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
+    freeEllerRows(&rows);
+    free(right);
+    free(down);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+    return ok && fseeko(stream, 0, SEEK_END) == 0 && !ferror(stream);
+}
+
+bool ellerGenStream(FILE *stream, size_t width, size_t height,
+                    ellerStreamFormat_t format, MazeRng_t *rng,
+                    uint64_t seed) {
+    MazeRng_t endsRng = *rng;
+    Point_t start, stop;
+
+    // The ends are needed before the first row goes out. They come from a
+    // stream of their own, so the walls match ellerGen() for the same seed.
+    mazeRngJump(&endsRng);
+    getRandomStartAndStop(width, height, &endsRng, &start, &stop);
+
+    switch (format) {
+        case ellerBinary:
+            return streamBinary(stream, width, height, rng, start, stop, seed);
+        case ellerText:
+        default:
+            return streamText(stream, width, height, rng, start, stop);
+    }
 }
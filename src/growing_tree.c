@@ -1,23 +1,193 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "growing_tree.h"
+#include "stepObserver.h"
+
+// How the active cells are stored, picked by the cells a method takes.
+typedef enum {
+    activeDeque,  // taken only from the ends
+    activeSwap,   // taken only at random, so their order does not matter
+    activeOrdered // taken by rank, from the middle or mixed with random
+} activeKind_t;
+
+// The active cells, oldest first. Every cell is added once, so slots are
+// never reused: the deque only moves its head forward, and the ordered set
+// marks the slots still in use in a bitmap. A Fenwick tree of the number of
+// marks in each word of the bitmap finds a rank a word at a time. The tree
+// is padded to a power of two words so a search never checks its bounds.
+typedef struct {
+    activeKind_t kind;
+    uint32_t *cells;
+    uint64_t *used;
+    uint32_t *counts;
+    size_t words;
+    size_t head;
+    size_t added;
+    size_t count;
+} ActiveCells_t;
+
+static activeKind_t methodToActiveKind(growingTreeMethods_t method) {
+    switch (method) {
+        case newestTree:
+        case oldestTree:
+        case newest_oldestTree:
+            return activeDeque;
+        case randomTree:
+            return activeSwap;
+        default:
+            return activeOrdered;
+    }
+}
+
+static ActiveCells_t createActiveCells(growingTreeMethods_t method,
+                                       size_t sz) {
+    ActiveCells_t active = {.kind = methodToActiveKind(method),
+                            .cells = NULL,
+                            .used = NULL,
+                            .counts = NULL,
+                            .words = 1,
+                            .head = 0,
+                            .added = 0,
+                            .count = 0};
+
+    while (active.words * 64 < sz) {
+        active.words *= 2;
+    }
+
+    active.cells = malloc(sizeof(*active.cells) * (sz ? sz : 1));
+    if (active.kind == activeOrdered) {
+        active.used = calloc(active.words + 1, sizeof(*active.used));
+        active.counts = calloc(active.words + 1, sizeof(*active.counts));
+    }
+    if (active.cells == NULL ||
+        (active.kind == activeOrdered &&
+         (active.used == NULL || active.counts == NULL))) {
+        perror("Failed to allocate active cells");
+        exit(EXIT_FAILURE);
+    }
+
+    return active;
+}
+
+static void freeActiveCells(ActiveCells_t *active) {
+    free(active->cells);
+    free(active->used);
+    free(active->counts);
+    active->cells = NULL;
+    active->used = NULL;
+    active->counts = NULL;
+    active->count = 0;
+}
+
+// Marks a slot of the ordered set as used or not.
+static void markSlot(ActiveCells_t *active, size_t slot, bool used) {
+    uint64_t bit = (uint64_t)1 << (slot & 63);
+
+    if (used) {
+        active->used[slot >> 6] |= bit;
+    } else {
+        active->used[slot >> 6] &= ~bit;
+    }
+
+    for (size_t i = (slot >> 6) + 1; i <= active->words; i += i & -i) {
+        active->counts[i] += used ? 1 : -1;
+    }
+}
 
-static void delete(size_t *sz, size_t array[*sz], size_t pos) {
-    if (pos < *sz) {
-        for (size_t i = pos; i < *sz; i++) {
-            array[i] = array[i + 1];
+// Finds the position of the set bit of x with rank set bits below it.
+static unsigned selectBit(uint64_t x, unsigned rank) {
+    uint64_t counts = x - ((x >> 1) & 0x5555555555555555);
+    unsigned pos = 0;
+
+    // byte k of counts is the number of set bits in bytes 0 to k
+    counts = (counts & 0x3333333333333333) +
+             ((counts >> 2) & 0x3333333333333333);
+    counts = ((counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0f) *
+             0x0101010101010101;
+
+    while (((counts >> pos) & 0xff) <= rank) {
+        pos += 8;
+    }
+    if (pos > 0) {
+        rank -= (counts >> (pos - 8)) & 0xff;
+    }
+
+    for (x >>= pos; rank > 0; rank--) {
+        x &= x - 1;
+    }
+
+    return pos + __builtin_ctzll(x);
+}
+
+// Finds the used slot of the ordered set with rank used slots before it.
+static size_t findSlot(const ActiveCells_t *active, size_t rank) {
+    size_t word = 0;
+
+    for (size_t step = active->words; step > 0; step /= 2) {
+        if (active->counts[word + step] <= rank) {
+            word += step;
+            rank -= active->counts[word];
         }
+    }
+
+    return word * 64 + selectBit(active->used[word], rank);
+}
+
+static void addActive(ActiveCells_t *active, uint32_t cell) {
+    switch (active->kind) {
+        case activeDeque:
+            active->cells[active->head + active->count] = cell;
+            break;
+        case activeSwap:
+            active->cells[active->count] = cell;
+            break;
+        case activeOrdered:
+            active->cells[active->added] = cell;
+            markSlot(active, active->added++, true);
+            break;
+    }
+
+    active->count++;
+}
+
+// Gets the slot of the active cell with rank cells older than it.
+static size_t activeSlot(const ActiveCells_t *active, size_t rank) {
+    switch (active->kind) {
+        case activeDeque:
+            return active->head + rank;
+        case activeOrdered:
+            return findSlot(active, rank);
+        case activeSwap:
+        default:
+            return rank;
+    }
+}
 
-        *sz -= 1;
+// Removes the active cell in a slot. A deque only gives up its ends.
+static void removeActive(ActiveCells_t *active, size_t slot) {
+    switch (active->kind) {
+        case activeDeque:
+            if (slot == active->head) {
+                active->head++;
+            }
+            break;
+        case activeSwap:
+            active->cells[slot] = active->cells[active->count - 1];
+            break;
+        case activeOrdered:
+            markSlot(active, slot, false);
+            break;
     }
+
+    active->count--;
 }
 
 static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
-                                  size_t sz) {
+                                  size_t sz, MazeRng_t *rng) {
     switch (method) {
         case newestTree:
             return sz - 1;
@@ -32,11 +202,11 @@ static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
             break;
 
         case randomTree:
-            return rand() % sz;
+            return mazeRngBelow(rng, sz);
             break;
 
         case newest_middleTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return sz - 1;
             } else {
                 return sz / 2;
@@ -44,7 +214,7 @@ static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
             break;
 
         case newest_oldestTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return sz - 1;
             } else {
                 return 0;
@@ -52,15 +222,15 @@ static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
             break;
 
         case newest_randomTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return sz - 1;
             } else {
-                return rand() % sz;
+                return mazeRngBelow(rng, sz);
             }
             break;
 
         case middle_oldestTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return sz / 2;
             } else {
                 return 0;
@@ -68,18 +238,18 @@ static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
             break;
 
         case middle_randomTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return sz / 2;
             } else {
-                return rand() % sz;
+                return mazeRngBelow(rng, sz);
             }
 			break;
 
         case oldest_randomTree:
-            if ((double)rand() / RAND_MAX < split) {
+            if (mazeRngUnit(rng) < split) {
                 return 0;
             } else {
-                return rand() % sz;
+                return mazeRngBelow(rng, sz);
             }
 			break;
 
@@ -93,120 +263,91 @@ static size_t grabIndexFromMethod(growingTreeMethods_t method, double split,
     }
 }
 
-void growingTreeGen(Maze_t *maze, growingTreeMethods_t method, double split) {
+OBSERVED_INLINE void generate(Maze_t *maze, growingTreeMethods_t method,
+                              double split, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     size_t sz = maze->width * maze->height;
-    size_t trackedCellsSz = 0;
-    size_t trackedCells[sz];
+    ActiveCells_t active = createActiveCells(method, sz);
+    size_t firstI;
     Point_t point;
 
-    srand(time(NULL));
-
     // Select first cell at random
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
-
-    trackedCells[trackedCellsSz++] = pointToIndex(point, maze->width);
-    maze->cells[trackedCells[0]].visited = 1;
+    point.x = mazeRngBelow(rng, maze->width);
+    point.y = mazeRngBelow(rng, maze->height);
+
+	observeFrame(observer, maze, renderIgnoreVisited);
+
+    firstI = pointToIndex(point, maze->width);
+    addActive(&active, firstI);
+    maze->cells[firstI].visited = 1;
+    if (observer) {
+        maze->cells[firstI].observing = 1;
+        observeCell(observer, maze, firstI);
+        observeFrame(observer, maze, renderIgnoreVisited);
+    }
 
-    while (trackedCellsSz > 0) {
-        size_t trackedI = grabIndexFromMethod(method, split, trackedCellsSz);
+    while (active.count > 0) {
+        size_t slot = activeSlot(
+            &active, grabIndexFromMethod(method, split, active.count, rng));
+        size_t cellI = active.cells[slot];
         size_t directionsCount = 0;
         Direction_t dir[4];
         bool foundCell = false;
 
-        point = indexToPoint(trackedCells[trackedI], maze->width);
-        directionsCount = getRandomDirections(point, *maze, dir);
+        point = indexToPoint(cellI, maze->width);
+        directionsCount = getRandomDirections(point, *maze, dir, rng);
 
         for (size_t i = 0; !foundCell && i < directionsCount; i++) {
             Point_t newPoint = pointShift(point, dir[i]);
             size_t newI = pointToIndex(newPoint, maze->width);
 
             if (maze->cells[newI].visited == 0) {
-                mazeConnectCells(maze, trackedCells[trackedI], newI, dir[i]);
-				trackedCells[trackedCellsSz++] = newI;
+                mazeConnectCells(maze, cellI, newI, dir[i]);
+                addActive(&active, newI);
                 maze->cells[newI].visited = 1;
+                if (observer) {
+                    maze->cells[newI].observing = 1;
+                }
+                observeCell(observer, maze, cellI);
+                observeCell(observer, maze, newI);
                 foundCell = true;
             }
         }
 
         if (!foundCell) {
-            delete (&trackedCellsSz, trackedCells, trackedI);
+            if (observer) {
+                maze->cells[cellI].observing = 0;
+                observeCell(observer, maze, cellI);
+            }
+            removeActive(&active, slot);
         }
+		observeFrame(observer, maze, renderIgnoreVisited);
     }
 
+    freeActiveCells(&active);
+
     // reset visited
     for (size_t i = 0; i < sz; i++) {
         maze->cells[i].visited = 0;
+        observeCell(observer, maze, i);
     }
 
     // assign start and stop location
-    assignRandomStartAndStop(maze);
+    assignRandomStartAndStopObserved(maze, rng, observer);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    // write the finished maze
+    observeDone(observer, maze);
 }
 
-void growingTreeGenWithSteps(Maze_t *maze, growingTreeMethods_t method,
-                             double split, FILE *restrict stream) {
-    size_t sz = maze->width * maze->height;
-    size_t trackedCellsSz = 0;
-    size_t trackedCells[sz];
-    Point_t point;
-
-    srand(time(NULL));
-
-    // Select first cell at random
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
-
-	fprintStepIgnoreVisted(stream, maze);
-
-    trackedCells[trackedCellsSz++] = pointToIndex(point, maze->width);
-    maze->cells[trackedCells[0]].visited = 1;
-    maze->cells[trackedCells[0]].observing = 1;
-
-	fprintStepIgnoreVisted(stream, maze);
-
-    while (trackedCellsSz > 0) {
-        size_t trackedI = grabIndexFromMethod(method, split, trackedCellsSz);
-        size_t directionsCount = 0;
-        Direction_t dir[4];
-        bool foundCell = false;
-
-        point = indexToPoint(trackedCells[trackedI], maze->width);
-        directionsCount = getRandomDirections(point, *maze, dir);
-
-        for (size_t i = 0; !foundCell && i < directionsCount; i++) {
-            Point_t newPoint = pointShift(point, dir[i]);
-            size_t newI = pointToIndex(newPoint, maze->width);
-
-            if (maze->cells[newI].visited == 0) {
-                mazeConnectCells(maze, trackedCells[trackedI], newI, dir[i]);
-				trackedCells[trackedCellsSz] = newI;
-				maze->cells[trackedCells[trackedCellsSz++]].observing = 1;
-                maze->cells[newI].visited = 1;
-                foundCell = true;
-            }
-        }
-
-        if (!foundCell) {
-            maze->cells[trackedCells[trackedI]].observing = 0;
-            delete (&trackedCellsSz, trackedCells, trackedI);
-        }
-		fprintStepIgnoreVisted(stream, maze);
-    }
-
-    // reset visited
-    for (size_t i = 0; i < sz; i++) {
-        maze->cells[i].visited = 0;
-    }
-
-    // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
+void growingTreeGen(Maze_t *maze, growingTreeMethods_t method, double split,
+                    MazeRng_t *rng) {
+    generate(maze, method, split, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void growingTreeGenObserved(Maze_t *maze, growingTreeMethods_t method,
+                            double split, MazeRng_t *rng,
+                            const StepObserver_t *observer) {
+    generate(maze, method, split, rng, observer);
 }
 
 growingTreeMethods_t strToTreeMethod(const char *str) {
@@ -1,190 +1,247 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "huntAndKill.h"
 #include "MazeTools.h"
+#include "mazeBits.h"
+#include "stepObserver.h"
+
+// The visited cells as a plane laid out like those of MazeBits_t, one row of
+// stride words per row of cells. The padding bits are never set. Every word
+// before the cursor is a full row word, so the hunt resumes there.
+typedef struct {
+    uint64_t *words;
+    size_t width;
+    size_t height;
+    size_t stride;
+    size_t cursor;
+} VisitedBits_t;
+
+static VisitedBits_t createVisitedBits(size_t width, size_t height) {
+    VisitedBits_t visited = {.words = NULL, .width = width, .height = height,
+                             .stride = (width + 63) / 64, .cursor = 0};
+    size_t words = visited.stride * height;
+
+    visited.words = calloc(words ? words : 1, sizeof(*visited.words));
+    if (visited.words == NULL) {
+        perror("Failed to allocate visited cells");
+        exit(EXIT_FAILURE);
+    }
 
-static Point_t hunt(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t dirSz, newI;
-    Point_t point, newPoint;
-    Direction_t dir[4];
-
-    for (size_t i = 0; i < sz; i++) {
-        if (maze->cells[i].visited == 0) {
-            point = indexToPoint(i, maze->width);
-            dirSz = getRandomDirections(point, *maze, dir);
-
-            for (size_t j = 0; j < dirSz; j++) {
-                newPoint = pointShift(point, dir[j]);
-                newI = pointToIndex(newPoint, maze->width);
+    return visited;
+}
 
-                if (maze->cells[newI].visited == 1) {
-                    mazeConnectCells(maze, i, newI, dir[j]);
-                    return indexToPoint(i, maze->width);
-                }
-            }
-        }
-    }
+static void freeVisitedBits(VisitedBits_t *visited) {
+    free(visited->words);
+    visited->words = NULL;
+    visited->cursor = 0;
+}
 
-    return (Point_t){0, 0};
+static size_t visitedPos(const VisitedBits_t *visited, Point_t point) {
+    return point.y * visited->stride * 64 + point.x;
 }
 
-static Point_t huntWithSteps(Maze_t *maze, FILE *restrict stream) {
-    Point_t point = {0, 0};
-    Point_t foundPoint = {0, 0};
-    Point_t newPoint;
-    size_t i = 0;
-    size_t dirSz, newI;
-    bool found = false;
-    Direction_t dir[4];
-    Direction_t foundDir;
+static void visit(Maze_t *maze, VisitedBits_t *visited, Point_t point) {
+    maze->cells[pointToIndex(point, maze->width)].visited = 1;
+    bitsSet(visited->words, visitedPos(visited, point));
+}
 
-    for (point.y = 0; point.y < maze->height && !found; ++point.y) {
-        for (point.x = 0; point.x < maze->width; ++point.x) {
-			i = pointToIndex(point, maze->width);
-            maze->cells[i].observing = 1;
-            if (maze->cells[i].visited == 0 && !found) {
-                dirSz = getRandomDirections(point, *maze, dir);
-
-                for (size_t j = 0; j < dirSz; j++) {
-                    newPoint = pointShift(point, dir[j]);
-                    newI = pointToIndex(newPoint, maze->width);
-
-                    if (maze->cells[newI].visited == 1) {
-                        found = true;
-                        foundPoint = point;
-                        foundDir = dir[j];
-                        break;
-                    }
-                }
-            }
-        }
+static bool isVisited(const VisitedBits_t *visited, Point_t point) {
+    return bitsTest(visited->words, visitedPos(visited, point));
+}
 
-        fprintStepIgnoreVisted(stream, maze);
+// Gets the unvisited cells of word w of the plane.
+static uint64_t unvisitedWord(const VisitedBits_t *visited, size_t w) {
+    size_t tail = visited->width % 64;
 
-        for (point.x = 0; point.x < maze->width; ++point.x) {
-			i = pointToIndex(point, maze->width);
-            maze->cells[i].observing = 0;
-        }
+    if (tail && w % visited->stride == visited->stride - 1) {
+        return ~visited->words[w] & (((uint64_t)1 << tail) - 1);
     }
 
+    return ~visited->words[w];
+}
 
-    if (found) {
-		i = pointToIndex(foundPoint, maze->width);
-		maze->cells[i].observing = 1;
-		fprintStepIgnoreVisted(stream, maze);
-		maze->cells[i].observing = 0;
+// Gets the cells of word w of the plane with a visited neighbour.
+static uint64_t nearVisitedWord(const VisitedBits_t *visited, size_t w) {
+    const uint64_t *words = visited->words;
+    size_t stride = visited->stride;
+    size_t col = w % stride;
+    uint64_t near = (words[w] << 1) | (words[w] >> 1);
 
-        mazeConnectCells(maze, i, newI, foundDir);
-        fprintStepIgnoreVisted(stream, maze);
+    if (col > 0) {
+        near |= words[w - 1] >> 63;
+    }
+    if (col + 1 < stride) {
+        near |= words[w + 1] << 63;
+    }
+    if (w >= stride) {
+        near |= words[w - stride];
+    }
+    if (w + stride < stride * visited->height) {
+        near |= words[w + stride];
     }
 
-    return foundPoint;
+    return near;
 }
 
-void huntAndKillGen(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t dirSz, newI;
+// Finds the first unvisited cell next to a visited one and connects them.
+// Scanning cell by cell from 0 drew directions at every unvisited cell on the
+// way; those draws are still made, so the maze for a seed is unchanged, but
+// the cells are found a word at a time from the cursor. An observer sees the
+// scan one row at a time from the top, up to the row of the cell.
+OBSERVED_INLINE Point_t hunt(Maze_t *maze, VisitedBits_t *visited,
+                             MazeRng_t *rng, const StepObserver_t *observer) {
+    Point_t point = {0, 0};
+    Point_t foundPoint = {0, 0};
+    Point_t newPoint = {0, 0};
+    size_t words = visited->stride * visited->height;
+    size_t i, dirSz;
+    uint32_t scannedRows;
+    uint64_t open, candidates;
     bool found = false;
-    bool wallBroken = false;
-    Point_t point, newPoint;
     Direction_t dir[4];
+    Direction_t foundDir = up;
 
-    srand(time(NULL));
-
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
+    while (visited->cursor < words &&
+           unvisitedWord(visited, visited->cursor) == 0) {
+        visited->cursor++;
+    }
 
-	maze->cells[pointToIndex(point, maze->width)].visited = 1;
+    for (size_t w = visited->cursor; w < words && !found; w++) {
+        open = unvisitedWord(visited, w);
+        candidates = open & nearVisitedWord(visited, w);
+        if (candidates) {
+            // the cells before the first candidate
+            open &= (candidates & -candidates) - 1;
+        }
 
-    do {
-        do {
-            dirSz = getRandomDirections(point, *maze, dir);
+        for (; open != 0; open &= open - 1) {
+            skipRandomDirections(rng);
+        }
 
-            wallBroken = false;
+        if (candidates) {
+            point.y = w / visited->stride;
+            point.x = w % visited->stride * 64 + __builtin_ctzll(candidates);
+            dirSz = getRandomDirections(point, *maze, dir, rng);
 
-            for (size_t i = 0; i < dirSz && !wallBroken; i++) {
-                newPoint = pointShift(point, dir[i]);
-                newI = pointToIndex(newPoint, maze->width);
+            for (size_t j = 0; j < dirSz; j++) {
+                newPoint = pointShift(point, dir[j]);
 
-                if (maze->cells[newI].visited == 0) {
-					mazeBreakWall(maze, point, dir[i]);
-                    maze->cells[newI].visited = 1;
-                    wallBroken = true;
-                    point = newPoint;
+                if (isVisited(visited, newPoint)) {
+                    found = true;
+                    foundPoint = point;
+                    foundDir = dir[j];
+                    break;
                 }
             }
-        } while (wallBroken);
+        }
+    }
 
-        point = hunt(maze);
-        found = maze->cells[pointToIndex(point, maze->width)].visited == 1;
-        maze->cells[pointToIndex(point, maze->width)].visited = 1;
-    } while (!found);
+    if (observer) {
+        scannedRows = found ? foundPoint.y + 1 : maze->height;
 
-    for (size_t i = 0; i < sz; i++) {
-        maze->cells[i].visited = 0;
+        for (point.y = 0; point.y < scannedRows; ++point.y) {
+            for (point.x = 0; point.x < maze->width; ++point.x) {
+                i = pointToIndex(point, maze->width);
+                maze->cells[i].observing = 1;
+                observeCell(observer, maze, i);
+            }
+
+            observeFrame(observer, maze, renderIgnoreVisited);
+
+            for (point.x = 0; point.x < maze->width; ++point.x) {
+                i = pointToIndex(point, maze->width);
+                maze->cells[i].observing = 0;
+                observeCell(observer, maze, i);
+            }
+        }
     }
 
-    // assign start and stop location
-    assignRandomStartAndStop(maze);
+    if (found) {
+        size_t newI = pointToIndex(newPoint, maze->width);
+
+        i = pointToIndex(foundPoint, maze->width);
+        if (observer) {
+            maze->cells[i].observing = 1;
+            observeCell(observer, maze, i);
+            observeFrame(observer, maze, renderIgnoreVisited);
+            maze->cells[i].observing = 0;
+        }
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+        mazeConnectCells(maze, i, newI, foundDir);
+        observeCell(observer, maze, i);
+        observeCell(observer, maze, newI);
+        observeFrame(observer, maze, renderIgnoreVisited);
+    }
+
+    return foundPoint;
 }
 
-void huntAndKillGenWithSteps(Maze_t *maze, FILE *restrict stream) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     size_t sz = maze->width * maze->height;
-    size_t dirSz, newI;
+    VisitedBits_t visited = createVisitedBits(maze->width, maze->height);
+    size_t dirSz;
     bool found = false;
     bool wallBroken = false;
     Point_t point, newPoint;
     Direction_t dir[4];
 
-    srand(time(NULL));
-	
-	fprintStep(stream, maze);
+    observeFrame(observer, maze, renderPlain);
 
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
+    point.x = mazeRngBelow(rng, maze->width);
+    point.y = mazeRngBelow(rng, maze->height);
 
-	maze->cells[pointToIndex(point, maze->width)].visited = 1;
+    visit(maze, &visited, point);
+    observeCell(observer, maze, pointToIndex(point, maze->width));
 
     do {
         do {
-            dirSz = getRandomDirections(point, *maze, dir);
+            dirSz = getRandomDirections(point, *maze, dir, rng);
 
             wallBroken = false;
 
             for (size_t i = 0; i < dirSz && !wallBroken; i++) {
                 newPoint = pointShift(point, dir[i]);
-                newI = pointToIndex(newPoint, maze->width);
 
-                if (maze->cells[newI].visited == 0) {
-					mazeBreakWall(maze, point, dir[i]);
-                    maze->cells[newI].visited = 1;
+                if (!isVisited(&visited, newPoint)) {
+                    mazeBreakWall(maze, point, dir[i]);
+                    visit(maze, &visited, newPoint);
+                    observeWall(observer, maze, point, dir[i]);
                     wallBroken = true;
                     point = newPoint;
-                    fprintStepIgnoreVisted(stream, maze);
+                    observeFrame(observer, maze, renderIgnoreVisited);
                 }
             }
         } while (wallBroken);
 
-        point = huntWithSteps(maze, stream);
-        found = maze->cells[pointToIndex(point, maze->width)].visited == 1;
-        maze->cells[pointToIndex(point, maze->width)].visited = 1;
+        point = hunt(maze, &visited, rng, observer);
+        found = isVisited(&visited, point);
+        visit(maze, &visited, point);
+        observeCell(observer, maze, pointToIndex(point, maze->width));
     } while (!found);
 
+    freeVisitedBits(&visited);
+
     for (size_t i = 0; i < sz; i++) {
         maze->cells[i].visited = 0;
+        observeCell(observer, maze, i);
     }
 
     // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
+    assignRandomStartAndStopObserved(maze, rng, observer);
+
+    // write the finished maze
+    observeDone(observer, maze);
+}
+
+void huntAndKillGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void huntAndKillGenObserved(Maze_t *maze, MazeRng_t *rng,
+                            const StepObserver_t *observer) {
+    generate(maze, rng, observer);
 }
@@ -1,120 +1,86 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "MazeTools.h"
+#include "disjointSet.h"
 #include "kruskal.h"
+#include "stepObserver.h"
 
-void kruskalGen(Maze_t *maze) {
+// an edge is the index of a cell times two plus the wall it crosses
+#define EDGE_UP 0
+#define EDGE_LEFT 1
+
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     size_t sz = maze->width * maze->height;
     size_t edgeCount = 0;
-    Edge_t *edges = malloc(sizeof(*edges) * sz * 2);
-    Tree_t *trees = malloc(sizeof(*trees) * sz);
-
-    for (size_t i = 0; i < sz; i++) {
-        Point_t pt = indexToPoint(i, maze->width);
-
-        if (pt.y > 0) {
-            edges[edgeCount].point = pt;
-            edges[edgeCount++].dir = up;
-        }
-
-        if (pt.x > 0) {
-            edges[edgeCount].point = pt;
-            edges[edgeCount++].dir = left;
-        }
-
-        trees[i] = (Tree_t){i, NULL, NULL, NULL};
+    uint32_t *edges;
+    DisjointSet_t sets;
+
+    // the edge codes would wrap and join the wrong cells
+    if (sz > UINT32_MAX / 2) {
+        fprintf(stderr,
+                "Kruskal's algorithm can not generate more than %u cells\n",
+                UINT32_MAX / 2);
+        exit(EXIT_FAILURE);
     }
 
-    // shuffle
-    srand(time(NULL));
-    for (size_t j = 0; j < 2; j++) {
-        for (size_t i = 0; i < edgeCount; i++) {
-            int randI = rand() % edgeCount;
-            Edge_t tmp = edges[i];
-            edges[i] = edges[randI];
-            edges[randI] = tmp;
-        }
-    }
-
-    for (size_t i = 0; i < edgeCount; i++) {
-        Point_t point = edges[i].point;
-        size_t i1 = pointToIndex(point, maze->width);
-        point = pointShift(point, edges[i].dir);
-        size_t i2 = pointToIndex(point, maze->width);
-
-        if (!isSameTree(trees + i1, trees + i2)) {
-			mazeConnectCells(maze, i1, i2, edges[i].dir);
-            joinTrees(trees + i1, trees + i2);
-        }
+    edges = malloc(sizeof(*edges) * sz * 2);
+    sets = createDisjointSet(sz);
+    if (edges == NULL) {
+        perror("Failed to allocate edges");
+        exit(EXIT_FAILURE);
     }
 
-    free(trees);
-    free(edges);
-
-    // assign start and stop location
-	assignRandomStartAndStop(maze);
-
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-}
-
-void kruskalGenWithSteps(Maze_t *maze, FILE *restrict stream) {
-    size_t sz = maze->width * maze->height;
-    size_t edgeCount = 0;
-    Edge_t *edges = malloc(sizeof(*edges) * sz * 2);
-    Tree_t *trees = malloc(sizeof(*trees) * sz);
-
     for (size_t i = 0; i < sz; i++) {
-		Point_t pt = indexToPoint(i, maze->width);
-
-        if (pt.y > 0) {
-            edges[edgeCount].point = pt;
-            edges[edgeCount++].dir = up;
+        if (i >= maze->width) {
+            edges[edgeCount++] = i * 2 + EDGE_UP;
         }
 
-        if (pt.x > 0) {
-            edges[edgeCount].point = pt;
-            edges[edgeCount++].dir = left;
+        if (i % maze->width > 0) {
+            edges[edgeCount++] = i * 2 + EDGE_LEFT;
         }
-
-        trees[i] = (Tree_t){i, NULL, NULL, NULL};
     }
 
     // shuffle
-    srand(time(NULL));
-    for (size_t j = 0; j < 2; j++) {
-        for (size_t i = 0; i < edgeCount; i++) {
-            int randI = rand() % edgeCount;
-            Edge_t tmp = edges[i];
-            edges[i] = edges[randI];
-            edges[randI] = tmp;
-        }
+    for (size_t i = edgeCount; i > 1; i--) {
+        uint32_t randI = mazeRngBelow(rng, i);
+        uint32_t tmp = edges[i - 1];
+        edges[i - 1] = edges[randI];
+        edges[randI] = tmp;
     }
 
-    fprintStep(stream, maze);
+    observeFrame(observer, maze, renderPlain);
     for (size_t i = 0; i < edgeCount; i++) {
-        Point_t point = edges[i].point;
-		size_t i1 = pointToIndex(point, maze->width);
-        point = pointShift(point, edges[i].dir);
-        size_t i2 = pointToIndex(point, maze->width);
-
-        if (!isSameTree(trees + i1, trees + i2)) {
-			mazeConnectCells(maze, i1, i2, edges[i].dir);
-            joinTrees(trees + i1, trees + i2);
-            fprintStep(stream, maze);
+        size_t i1 = edges[i] / 2;
+        Direction_t dir = (edges[i] & EDGE_LEFT) ? left : up;
+        size_t i2 = dir == left ? i1 - 1 : i1 - maze->width;
+
+        if (disjointSetUnion(&sets, i1, i2)) {
+			mazeConnectCells(maze, i1, i2, dir);
+            observeCell(observer, maze, i1);
+            observeCell(observer, maze, i2);
+            observeFrame(observer, maze, renderPlain);
         }
     }
 
-    free(trees);
+    freeDisjointSet(&sets);
     free(edges);
 
     // assign start and stop location
-	assignRandomStartAndStopWithSteps(maze, stream);
+	assignRandomStartAndStopObserved(maze, rng, observer);
+
+    // write the finished maze
+    observeDone(observer, maze);
+}
+
+void kruskalGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void kruskalGenObserved(Maze_t *maze, MazeRng_t *rng,
+                        const StepObserver_t *observer) {
+    generate(maze, rng, observer);
 }
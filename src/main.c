@@ -21,8 +21,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "MazeTools.h"
+#include "eller.h"
+#include "growing_tree.h"
+#include "mazeBits.h"
+#include "mazeFile.h"
+#include "mazeRng.h"
+#include "recursiveDivision.h"
+#include "solverWorkspace.h"
+#include "stepSink.h"
 
 // clang-format off
 /***************************************************************//*******
@@ -31,6 +41,14 @@
 // clang-format on
 #define DEFAULT_HEIGHT 10
 #define DEFAULT_WIDTH 10
+#define VERBOSE_EVERY_OPT 256
+#define VERBOSE_FPS_OPT 257
+#define VERBOSE_QUEUE_OPT 258
+#define SEED_OPT 259
+#define TREE_METHOD_OPT 260
+#define SPLIT_OPT 261
+#define THREADS_OPT 262
+#define DEFAULT_SPLIT 0.5
 
 // clang-format off
 /**************************************************************//********
@@ -40,6 +58,14 @@
 static int quite_flag = 0;    // option to silence output
 static int verbose_flag = 0;  // option to print out everything
 static int input_flag = 0;    // option to read a maze from a file
+static int binary_input_flag = 0;   // the input file is a .mzb file
+static int binary_output_flag = 0;  // the output file is a .mzb file
+static uint64_t verbose_every = 1;  // option to write every Nth step
+static double verbose_fps = 0;      // option to cap the steps per second
+static int verbose_rate_flag = 0;   // either of the two options above is set
+static size_t verbose_queue = 0;    // option to write steps from a thread
+static int seed_flag = 0;           // option to generate from a given seed
+static int stream_flag = 0;         // option to stream an Eller maze out
 
 // clang-format off
 /***************************************************************//*******
@@ -77,6 +103,15 @@ int print(const char *frmt, ...);
  */
 int printError(const char *frmt, ...);
 
+/**@brief Picks a seed for when none is given.
+ *
+ * Mixes the time in nanoseconds with the process id, so runs started in the
+ * same second still get different mazes.
+ *
+ * @return The seed, never 0.
+ */
+uint64_t defaultSeed(void);
+
 // clang-format off
 /****************************************************************//******
  *                                MAIN                                  *
@@ -86,6 +121,9 @@ int main(int argc, char *argv[]) {
     int opt = 0;
     int opts_index = 0;
     Maze_t maze = {0, 0, NULL, NULL};
+    MazeBits_t bits;
+    uint64_t seed = 0;
+    char *inPath = NULL;
     size_t height = DEFAULT_HEIGHT;
     size_t width = DEFAULT_HEIGHT;
     Point_t start = {0, 0};
@@ -94,23 +132,38 @@ int main(int argc, char *argv[]) {
     FILE *inFile = NULL;
     FILE *outFile = stdout;
     FILE *stepFile = NULL;
+    StepSink_t sink;
+    MazeRng_t rng;
 	solveAlgo_t algorithm = INVALID_SOLVER;
 	bool foundAlgo = false;
+	genAlgo_t generator = kruskal;
+	growingTreeMethods_t treeMethod = newest_randomTree;
+	double split = DEFAULT_SPLIT;
+	size_t threads = 0;
 
     // clang-format off
 	static struct option long_opts[] = {
 		{"algorithm", required_argument, NULL, 'a'},
+		{"generator", required_argument, NULL, 'g'},
 		{"help", no_argument, NULL, 'h'},
 		{"input", required_argument, NULL, 'i'},
 		{"output", required_argument, NULL, 'o'},
 		{"quite", no_argument, &quite_flag, 1},
 		{"verbose", optional_argument, NULL, 'v'},
+		{"verbose-every", required_argument, NULL, VERBOSE_EVERY_OPT},
+		{"verbose-fps", required_argument, NULL, VERBOSE_FPS_OPT},
+		{"verbose-queue", required_argument, NULL, VERBOSE_QUEUE_OPT},
+		{"seed", required_argument, NULL, SEED_OPT},
+		{"tree-method", required_argument, NULL, TREE_METHOD_OPT},
+		{"split", required_argument, NULL, SPLIT_OPT},
+		{"threads", required_argument, NULL, THREADS_OPT},
+		{"stream", no_argument, NULL, 's'},
 		{0, 0, 0, 0}
 	};
 	// clang format on
 
 	// parse user arguments
-	while ((opt = getopt_long(argc, argv, "a:hi:qo:v::", long_opts, &opts_index)) != -1) {
+	while ((opt = getopt_long(argc, argv, "a:g:hi:qo:sv::", long_opts, &opts_index)) != -1) {
 		switch (opt) {
 			case 0: // long opt
 				break;
@@ -134,6 +187,25 @@ int main(int argc, char *argv[]) {
                     foundAlgo = true;
                 }
                 free(userChoice);
+                break;
+
+            case 'g': {
+                size_t len = strlen(optarg);
+                userChoice = malloc(sizeof(*userChoice) * (len + 1));
+
+                for (size_t i = 0; i < len; i++) {
+                    userChoice[i] = tolower(optarg[i]);
+                }
+                userChoice[len] = '\0';
+            }
+
+                generator = strToGenAlgo(userChoice);
+                free(userChoice);
+                if (generator == INVALID_ALGORITHM) {
+                    printError("ERROR: %s is not a valid generator\n", optarg);
+                    help();
+                    return EXIT_FAILURE;
+                }
                 break;
 
 			case 'h':
@@ -142,11 +214,17 @@ int main(int argc, char *argv[]) {
 				break;
 
 			case 'i':
-                inFile = fopen(optarg, "r");
-                if (!inFile) {
-                    printError("ERROR opening \"%s\": %s", optarg,
-                               strerror(errno));
-                    return EXIT_FAILURE;
+                if (isMazeFilePath(optarg)) {
+                    // mapped later, once the options are known
+                    inPath = optarg;
+                    binary_input_flag = 1;
+                } else {
+                    inFile = fopen(optarg, "r");
+                    if (!inFile) {
+                        printError("ERROR opening \"%s\": %s", optarg,
+                                   strerror(errno));
+                        return EXIT_FAILURE;
+                    }
                 }
 				input_flag = 1;
 				break;
@@ -155,6 +233,10 @@ int main(int argc, char *argv[]) {
 				quite_flag = 1;
 				break;
 
+			case 's':
+				stream_flag = 1;
+				break;
+
             case 'o':
                 outFile = fopen(optarg, "w");
                 if (!outFile) {
@@ -162,6 +244,7 @@ int main(int argc, char *argv[]) {
                                strerror(errno));
                     return EXIT_FAILURE;
                 }
+                binary_output_flag = isMazeFilePath(optarg);
                 break;
 
 			case 'v':
@@ -183,9 +266,103 @@ int main(int argc, char *argv[]) {
                         return EXIT_FAILURE;
                     }
                 }
+                sink = createStepSink(stepFile, optarg && isStepLogPath(optarg)
+                                                    ? deltaSteps
+                                                    : textSteps);
                 verbose_flag = 1;
                 break;
 
+            case VERBOSE_EVERY_OPT: {
+                char *end;
+
+                verbose_every = strtoull(optarg, &end, 10);
+                if (verbose_every == 0 || *end != '\0') {
+                    printError("ERROR: %s is not a valid step count\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                verbose_rate_flag = 1;
+            }
+                break;
+
+            case VERBOSE_FPS_OPT: {
+                char *end;
+
+                verbose_fps = strtod(optarg, &end);
+                if (!(verbose_fps > 0) || *end != '\0') {
+                    printError("ERROR: %s is not a valid frame rate\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                verbose_rate_flag = 1;
+            }
+                break;
+
+            case VERBOSE_QUEUE_OPT: {
+                char *end;
+
+                verbose_queue = strtoull(optarg, &end, 10);
+                if (verbose_queue == 0 || *end != '\0') {
+                    printError("ERROR: %s is not a valid queue depth\n", optarg);
+                    return EXIT_FAILURE;
+                }
+            }
+                break;
+
+            case SEED_OPT: {
+                char *end;
+
+                errno = 0;
+                seed = strtoull(optarg, &end, 0);
+                if (errno != 0 || *optarg == '\0' || *end != '\0') {
+                    printError("ERROR: %s is not a valid seed\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                seed_flag = 1;
+            }
+                break;
+
+            case TREE_METHOD_OPT: {
+                size_t len = strlen(optarg);
+                userChoice = malloc(sizeof(*userChoice) * (len + 1));
+
+                for (size_t i = 0; i < len; i++) {
+                    userChoice[i] = tolower(optarg[i]);
+                }
+                userChoice[len] = '\0';
+            }
+
+                treeMethod = strToTreeMethod(userChoice);
+                free(userChoice);
+                if (treeMethod == INVALID_METHOD) {
+                    printError("ERROR: %s is not a valid growing tree method\n",
+                               optarg);
+                    help();
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case SPLIT_OPT: {
+                char *end;
+
+                split = strtod(optarg, &end);
+                if (!(split >= 0 && split <= 1) || *end != '\0') {
+                    printError("ERROR: %s is not a valid split\n", optarg);
+                    return EXIT_FAILURE;
+                }
+            }
+                break;
+
+            case THREADS_OPT: {
+                char *end;
+
+                threads = strtoull(optarg, &end, 10);
+                if (threads == 0 || *end != '\0') {
+                    printError("ERROR: %s is not a valid thread count\n",
+                               optarg);
+                    return EXIT_FAILURE;
+                }
+            }
+                break;
+
             case '?':
 				puts("Unrecognized option");
 				help();
@@ -234,39 +411,138 @@ int main(int argc, char *argv[]) {
 		fflush(stdout);
 	}
 
+	if (stream_flag && (input_flag || verbose_flag)) {
+		printError("ERROR: --stream can not be used with --input or --verbose\n");
+		return EXIT_FAILURE;
+	}
+
+	if (verbose_rate_flag && !verbose_flag) {
+		printError("ERROR: --verbose-every and --verbose-fps need --verbose\n");
+		return EXIT_FAILURE;
+	}
+
+	if (verbose_queue && !verbose_flag) {
+		printError("ERROR: --verbose-queue needs --verbose\n");
+		return EXIT_FAILURE;
+	}
+
+	if (threads && generator != rDivide) {
+		printError("ERROR: --threads only applies to the Divide generator\n");
+		return EXIT_FAILURE;
+	}
+
+	// a seed is only made up for a maze that is generated here
+	if (!seed_flag && !input_flag) {
+		seed = defaultSeed();
+	}
+
+	// a streamed maze is written a row at a time and never held or solved
+	if (stream_flag) {
+		rng = createMazeRng(seed);
+		if (!ellerGenStream(outFile, width, height,
+		                    binary_output_flag ? ellerBinary : ellerText, &rng,
+		                    seed)) {
+			printError("ERROR writing maze: %s\n", strerror(errno));
+			return EXIT_FAILURE;
+		}
+		if (outFile != stdout) {
+			fclose(outFile);
+		}
+		return EXIT_SUCCESS;
+	}
+
 	// Import or generate maze
-	if (input_flag) {
+	if (binary_input_flag) {
+		if (!loadMazeFile(inPath, &bits, &seed)) {
+			printError("ERROR loading \"%s\": %s\n", inPath, strerror(errno));
+			return EXIT_FAILURE;
+		}
+	} else if (input_flag) {
 		maze = importMaze(inFile);
 		fclose(inFile);
+		if (maze.cells == NULL) {
+			return EXIT_FAILURE;
+		}
 	} else {
+		rng = createMazeRng(seed);
 		maze = createMazeWH(width, height);
-		generateMaze(&maze, kruskal);
+		if (generator == growing_tree) {
+			growingTreeGen(&maze, treeMethod, split, &rng);
+		} else if (generator == rDivide && threads) {
+			recursiveDivisionGenThreads(&maze, &rng, threads);
+		} else {
+			generateMaze(&maze, generator, &rng);
+		}
 	}
 
 	if (!foundAlgo) {
 		algorithm = depthFirst;
 	}
 
-	// Find critical points
-	start = findStart(maze);
-	stop = findStop(maze);
+	// a mapped maze is solved in place unless every step has to be drawn
+	if (binary_input_flag && verbose_flag) {
+		maze = bitsToMaze(&bits);
+		freeMazeBits(&bits);
+		binary_input_flag = 0;
+	}
+
+	if (binary_input_flag) {
+		SolverWorkspace_t workspace =
+			createSolverWorkspace(bits.width * bits.height);
 
-	// solve maze
-	if (verbose_flag) {
-		solveMazeWithSteps(&maze, start, stop, algorithm, stepFile);
+		solveMazeBits(&bits, bits.start, bits.stop, algorithm, &workspace);
+		freeSolverWorkspace(&workspace);
 	} else {
-		solveMaze(&maze, start, stop, algorithm);
+		// Find critical points
+		start = findStart(maze);
+		stop = findStop(maze);
+
+		// solve maze
+		if (verbose_flag) {
+			StepObserver_t observer = stepSinkObserver(&sink);
+
+			setStepSinkRate(&sink, verbose_every, verbose_fps);
+			if (verbose_queue) {
+				startStepSinkWriter(&sink, verbose_queue);
+			}
+			solveMazeObserved(&maze, start, stop, algorithm, &observer);
+		} else {
+			solveMaze(&maze, start, stop, algorithm);
+		}
 	}
 
 	// output the results
-	fprintf(outFile, "%s", maze.str);
+	if (binary_output_flag) {
+		if (!binary_input_flag) {
+			bits = mazeToBits(&maze);
+		}
+		if (!writeMazeFile(outFile, &bits, seed)) {
+			printError("ERROR writing maze: %s\n", strerror(errno));
+		}
+	} else {
+		if (binary_input_flag) {
+			fprintMazeBits(outFile, &bits);
+		} else {
+			fprintMaze(outFile, &maze);
+		}
+	}
 
 	// cleanup
 	if (verbose_flag) {
+		freeStepSink(&sink);
 		fclose(stepFile);
 	}
 
-	freeMaze(maze);
+	if (outFile != stdout) {
+		fclose(outFile);
+	}
+
+	if (binary_input_flag || binary_output_flag) {
+		freeMazeBits(&bits);
+	}
+	if (!binary_input_flag) {
+		freeMaze(maze);
+	}
 
 	return EXIT_SUCCESS;
 }
@@ -286,10 +562,23 @@ void help(void) {
 	puts("");
 	puts("Options:");
     puts("  -a, --algorithm <algorithm>     Specifies the algorithm");
-	puts("  -i <file>, --input <file>       Import a maze from <file>");
+	puts("  -i <file>, --input <file>       Import a maze from <file> (.mzb is binary)");
 	puts("  -q, --quite                     Silence all output");
-	puts("  -o <file>, --output <file>      Output solved maze to <file>");
+	puts("  -o <file>, --output <file>      Output solved maze to <file> (.mzb is binary)");
 	puts("  -v [file], --verbose [file]     Send each step for solving to <file>");
+	puts("                                  (.mzd is a binary log, see MazeReplay)");
+	puts("  --verbose-every <n>             Only send every <n>th step");
+	puts("  --verbose-fps <f>               Send at most <f> steps per second");
+	puts("  --verbose-queue <n>             Write steps from a thread, <n> at a time");
+	puts("  -s, --stream                    Write an Eller maze a row at a time");
+	puts("                                  instead of solving one (.mzb must be a file)");
+	puts("  -g, --generator <generator>     Specifies the algorithm to generate with");
+	puts("  --tree-method <method>          The growing tree method (newest-random)");
+	puts("  --split <p>                     The odds a growing tree split takes its");
+	puts("                                  first method (0.5)");
+	puts("  --threads <n>                   Generate a Divide maze with <n> threads");
+	puts("                                  (one per processor)");
+	puts("  --seed <n>                      Generate the maze from seed <n>");
 	puts("  -h, --help                      Print this message");
     puts("");
     puts("Algorithms:");
@@ -297,6 +586,14 @@ void help(void) {
     puts("  Breadth (Breadth First)");
 	puts("  Dijkstra");
 	puts("  A-Star");
+    puts("");
+    puts("Generators:");
+    puts("  Kruskal (default), Prim, Back, Aldous-Broder, Growing-Tree,");
+    puts("  Hunt-and-Kill, Wilson, Eller, Divide, Sidewinder, Binary-Tree");
+    puts("");
+    puts("Growing tree methods:");
+    puts("  Newest, Middle, Oldest, Random, Newest-Middle, Newest-Oldest,");
+    puts("  Newest-Random, Middle-Oldest, Middle-Random, Oldest-Random");
     // clang-format on
 }
 
@@ -313,6 +610,17 @@ int printError(const char *frmt, ...) {
     return results;
 }
 
+uint64_t defaultSeed(void) {
+    struct timespec now;
+    uint64_t seed;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    seed = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    seed ^= (uint64_t)getpid() << 32;
+
+    return seed ? seed : 1;
+}
+
 int print(const char *frmt, ...) {
     va_list args;
     int results = 0;
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "MazeTools.h"
+#include "aStar.h"
+#include "binaryTree.h"
+#include "breadthFirst.h"
+#include "depthFirst.h"
+#include "dijkstra.h"
+#include "mazeBits.h"
+#include "sidewinder.h"
+#include "solverWorkspace.h"
+
+static uint64_t *allocPlane(size_t words, int fill) {
+    uint64_t *plane = malloc(sizeof(*plane) * (words ? words : 1));
+
+    if (plane == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(plane, fill, sizeof(*plane) * words);
+
+    return plane;
+}
+
+MazeBits_t createMazeBits(size_t width, size_t height) {
+    MazeBits_t bits;
+    size_t words;
+
+    bits.width = width;
+    bits.height = height;
+    bits.stride = (width + 63) / 64;
+    words = bits.stride * height;
+
+    bits.right = allocPlane(words, 0xff);
+    bits.down = allocPlane(words, 0xff);
+    bits.top = allocPlane(bits.stride, 0xff);
+    bits.left = allocPlane((height + 63) / 64, 0xff);
+    bits.visited = allocPlane(words, 0);
+    bits.path = allocPlane(words, 0);
+    bits.queued = allocPlane(words, 0);
+    bits.start = (Point_t){UINT32_MAX, UINT32_MAX};
+    bits.stop = (Point_t){UINT32_MAX, UINT32_MAX};
+    bits.mapping = NULL;
+    bits.mappingSz = 0;
+
+    return bits;
+}
+
+MazeBits_t mazeToBits(const Maze_t *maze) {
+    MazeBits_t bits = createMazeBits(maze->width, maze->height);
+    Point_t point;
+
+    for (point.y = 0; point.y < maze->height; point.y++) {
+        for (point.x = 0; point.x < maze->width; point.x++) {
+            Cell_t cell = maze->cells[pointToIndex(point, maze->width)];
+            size_t pos = mazeBitsPos(&bits, point);
+
+            if (!cell.right) {
+                bitsClear(bits.right, pos);
+            }
+            if (!cell.bottom) {
+                bitsClear(bits.down, pos);
+            }
+            if (point.y == 0 && !cell.top) {
+                bitsClear(bits.top, point.x);
+            }
+            if (point.x == 0 && !cell.left) {
+                bitsClear(bits.left, point.y);
+            }
+            if (cell.visited) {
+                bitsSet(bits.visited, pos);
+            }
+            if (cell.path) {
+                bitsSet(bits.path, pos);
+            }
+            if (cell.queued) {
+                bitsSet(bits.queued, pos);
+            }
+            if (cell.start) {
+                bits.start = point;
+            }
+            if (cell.stop) {
+                bits.stop = point;
+            }
+        }
+    }
+
+    return bits;
+}
+
+// Expands one row of the planes into cells.
+static void loadCellRow(const MazeBits_t *bits, uint32_t y, Cell_t *row) {
+    Point_t point = {0, y};
+
+    for (point.x = 0; point.x < bits->width; point.x++) {
+        Cell_t *cell = &row[point.x];
+        size_t pos = mazeBitsPos(bits, point);
+
+        *cell = (Cell_t){0};
+        cell->top = mazeBitsHasWall(bits, point, up);
+        cell->bottom = mazeBitsHasWall(bits, point, down);
+        cell->left = mazeBitsHasWall(bits, point, left);
+        cell->right = mazeBitsHasWall(bits, point, right);
+        cell->visited = bitsTest(bits->visited, pos);
+        cell->path = bitsTest(bits->path, pos);
+        cell->queued = bitsTest(bits->queued, pos);
+        cell->start = pointEqual(point, bits->start);
+        cell->stop = pointEqual(point, bits->stop);
+    }
+}
+
+Maze_t bitsToMaze(const MazeBits_t *bits) {
+    Maze_t maze = createMazeWH(bits->width, bits->height);
+
+    for (size_t y = 0; y < maze.height; y++) {
+        loadCellRow(bits, y, maze.cells + y * maze.width);
+    }
+
+    return maze;
+}
+
+void fprintMazeBits(FILE *restrict stream, const MazeBits_t *bits) {
+    size_t strWidth = bits->width * 2 + 1 + 1;
+    Cell_t *rows = malloc(sizeof(*rows) * bits->width * 2);
+    char *band = malloc(sizeof(*band) * strWidth * 2);
+    Cell_t *row = rows;
+    Cell_t *next = rows + bits->width;
+    Cell_t *tmp;
+
+    if (rows == NULL || band == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
+    }
+
+    loadCellRow(bits, 0, row);
+    renderMazeTopLine(row, bits->width, band);
+    fwrite(band, 1, strWidth, stream);
+
+    for (size_t y = 0; y < bits->height; y++) {
+        if (y + 1 < bits->height) {
+            loadCellRow(bits, y + 1, next);
+        }
+
+        renderMazeRowBand(row, y + 1 < bits->height ? next : NULL, bits->width,
+                          band);
+        fwrite(band, 1, strWidth * 2, stream);
+
+        tmp = row;
+        row = next;
+        next = tmp;
+    }
+
+    free(rows);
+    free(band);
+}
+
+void clearMazeBitsSearch(MazeBits_t *bits) {
+    size_t words = bits->stride * bits->height;
+
+    memset(bits->visited, 0, sizeof(*bits->visited) * words);
+    memset(bits->path, 0, sizeof(*bits->path) * words);
+    memset(bits->queued, 0, sizeof(*bits->queued) * words);
+}
+
+void freeMazeBits(MazeBits_t *bits) {
+    if (bits->mapping) {
+        munmap(bits->mapping, bits->mappingSz);
+    } else {
+        free(bits->right);
+        free(bits->down);
+        free(bits->top);
+        free(bits->left);
+    }
+    free(bits->visited);
+    free(bits->path);
+    free(bits->queued);
+    bits->right = NULL;
+    bits->down = NULL;
+    bits->top = NULL;
+    bits->left = NULL;
+    bits->visited = NULL;
+    bits->path = NULL;
+    bits->queued = NULL;
+    bits->mapping = NULL;
+    bits->mappingSz = 0;
+    bits->width = 0;
+    bits->height = 0;
+    bits->stride = 0;
+}
+
+bool generateMazeBits(MazeBits_t *bits, genAlgo_t algorithm, MazeRng_t *rng) {
+    bool state = false;
+
+    // the other algorithms carve through random access to whole cells, and
+    // going through a Maze_t would cost more memory than the planes save
+    switch (algorithm) {
+        case sidewinder:
+            sidewinderGenBits(bits, rng);
+            state = true;
+            break;
+        case binaryTree:
+            binaryTreeGenBits(bits, southWestTree, rng);
+            state = true;
+            break;
+        default:
+            break;
+    }
+
+    return state;
+}
+
+bool solveMazeBits(MazeBits_t *bits, Point_t start, Point_t stop,
+                   solveAlgo_t algorithm, SolverWorkspace_t *workspace) {
+    bool state = false;
+
+    switch (algorithm) {
+        case depthFirst:
+            state = depthFirstSolveBits(bits, start, stop, workspace);
+            break;
+        case breadthFirst:
+            state = breadthFirstSolveBits(bits, start, stop, workspace);
+            break;
+        case dijkstra:
+            state = dijkstraSolveBits(bits, start, stop, workspace);
+            break;
+        case aStar:
+            state = aStarSolveBits(bits, start, stop, workspace);
+            break;
+        case INVALID_SOLVER:
+            break;
+    }
+
+    return state;
+}
+
+void assignRandomStartAndStopBits(MazeBits_t *bits, MazeRng_t *rng) {
+    Point_t start, stop;
+
+    getRandomStartAndStop(bits->width, bits->height, rng, &start, &stop);
+
+    bits->start = start;
+    bits->stop = stop;
+}
@@ -0,0 +1,162 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mazeBits.h"
+#include "mazeFile.h"
+
+// the planes follow the header directly, so it must keep them 8 byte aligned
+_Static_assert(sizeof(MazeFileHeader_t) % sizeof(uint64_t) == 0,
+               "MazeFileHeader_t must keep the planes aligned");
+
+static size_t planeWords(size_t width, size_t height) {
+    return (width + 63) / 64 * height;
+}
+
+static size_t fileSize(size_t width, size_t height) {
+    size_t stride = (width + 63) / 64;
+
+    return sizeof(MazeFileHeader_t) +
+           sizeof(uint64_t) * (2 * planeWords(width, height) + stride +
+                               (height + 63) / 64);
+}
+
+// Checks a header read from a file of sz bytes. Everything in it is untrusted:
+// the dimensions must fit the coordinates of a Point_t without the cell count
+// or the file size wrapping, and the start and stop must be in the maze.
+static bool isValidHeader(const MazeFileHeader_t *header, size_t sz) {
+    uint64_t width = header->width;
+    uint64_t height = header->height;
+    size_t extra;
+
+    if (memcmp(header->magic, MAZE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byteOrder != MAZE_FILE_BYTE_ORDER) {
+        return false;
+    }
+
+    if (width == 0 || height == 0 || width > UINT32_MAX ||
+        height > UINT32_MAX || width > SIZE_MAX / height) {
+        return false;
+    }
+
+    // the words fileSize() adds up, which must not wrap either
+    extra = (width + 63) / 64 + (height + 63) / 64 +
+            sizeof(MazeFileHeader_t) / sizeof(uint64_t) + 1;
+    if (planeWords(width, height) > (SIZE_MAX / sizeof(uint64_t) - extra) / 2) {
+        return false;
+    }
+
+    return fileSize(width, height) == sz && header->start.x < width &&
+           header->start.y < height && header->stop.x < width &&
+           header->stop.y < height;
+}
+
+static uint64_t *allocZeroed(size_t words) {
+    // calloc leaves the pages of untouched rows unmapped
+    uint64_t *plane = calloc(words ? words : 1, sizeof(*plane));
+
+    if (plane == NULL) {
+        perror("Failed to allocate maze");
+        exit(EXIT_FAILURE);
+    }
+
+    return plane;
+}
+
+bool isMazeFilePath(const char *path) {
+    size_t len = strlen(path);
+
+    return len >= 4 && strcmp(path + len - 4, ".mzb") == 0;
+}
+
+bool writeMazeFile(FILE *stream, const MazeBits_t *bits, uint64_t seed) {
+    MazeFileHeader_t header;
+    size_t words = bits->stride * bits->height;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAZE_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = MAZE_FILE_BYTE_ORDER;
+    header.width = bits->width;
+    header.height = bits->height;
+    header.start = bits->start;
+    header.stop = bits->stop;
+    header.seed = seed;
+
+    return fwrite(&header, sizeof(header), 1, stream) == 1 &&
+           fwrite(bits->right, sizeof(*bits->right), words, stream) == words &&
+           fwrite(bits->down, sizeof(*bits->down), words, stream) == words &&
+           fwrite(bits->top, sizeof(*bits->top), bits->stride, stream) ==
+               bits->stride &&
+           fwrite(bits->left, sizeof(*bits->left), (bits->height + 63) / 64,
+                  stream) == (bits->height + 63) / 64;
+}
+
+bool loadMazeFile(const char *path, MazeBits_t *bits, uint64_t *seed) {
+    const MazeFileHeader_t *header;
+    struct stat info;
+    uint64_t *planes;
+    void *mapping;
+    size_t words;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        return false;
+    }
+
+    if ((size_t)info.st_size < sizeof(*header)) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+
+    // private and writable so solvers and generators can modify the walls
+    mapping = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                   0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    header = mapping;
+    if (!isValidHeader(header, info.st_size)) {
+        munmap(mapping, info.st_size);
+        errno = EINVAL;
+        return false;
+    }
+
+    // the whole file is about to be walked by a solver
+    madvise(mapping, info.st_size, MADV_WILLNEED);
+
+    bits->width = header->width;
+    bits->height = header->height;
+    bits->stride = (bits->width + 63) / 64;
+    bits->start = header->start;
+    bits->stop = header->stop;
+    if (seed) {
+        *seed = header->seed;
+    }
+
+    words = bits->stride * bits->height;
+    planes = (uint64_t *)(header + 1);
+    bits->right = planes;
+    bits->down = planes + words;
+    bits->top = planes + 2 * words;
+    bits->left = planes + 2 * words + bits->stride;
+    bits->visited = allocZeroed(words);
+    bits->path = allocZeroed(words);
+    bits->queued = allocZeroed(words);
+    bits->mapping = mapping;
+    bits->mappingSz = info.st_size;
+
+    return true;
+}
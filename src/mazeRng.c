@@ -0,0 +1,40 @@
+#include <stdint.h>
+
+#include "mazeRng.h"
+
+MazeRng_t createMazeRng(uint64_t seed) {
+    MazeRng_t rng;
+
+    // splitmix64 never yields four zero words in a row
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        rng.s[i] = z ^ (z >> 31);
+    }
+
+    return rng;
+}
+
+void mazeRngJump(MazeRng_t *rng) {
+    static const uint64_t jump[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                     0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (jump[i] & (uint64_t)1 << b) {
+                s[0] ^= rng->s[0];
+                s[1] ^= rng->s[1];
+                s[2] ^= rng->s[2];
+                s[3] ^= rng->s[3];
+            }
+            mazeRngNext(rng);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = s[i];
+    }
+}
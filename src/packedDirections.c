@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "packedDirections.h"
+
+DirectionStack_t createDirectionStack(size_t sz) {
+    DirectionStack_t stack = {.bits = NULL, .count = 0, .sz = 0};
+
+    // keep whole bytes so the packing never straddles an allocation
+    stack.sz = (sz + 3) & ~(size_t)3;
+    if (stack.sz == 0) {
+        stack.sz = 4;
+    }
+
+    stack.bits = malloc(stack.sz / 4);
+    if (stack.bits == NULL) {
+        perror("Failed to allocate stack");
+        exit(EXIT_FAILURE);
+    }
+
+    return stack;
+}
+
+void growDirectionStack(DirectionStack_t *stack) {
+    stack->sz *= 2;
+    stack->bits = realloc(stack->bits, stack->sz / 4);
+    if (stack->bits == NULL) {
+        perror("Failed to allocate stack");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void freeDirectionStack(DirectionStack_t *stack) {
+    free(stack->bits);
+    stack->bits = NULL;
+    stack->count = 0;
+    stack->sz = 0;
+}
+
+DirectionMap_t createDirectionMap(size_t sz) {
+    DirectionMap_t map = {.bits = NULL, .sz = sz};
+
+    map.bits = malloc(sz / 4 + 1);
+    if (map.bits == NULL) {
+        perror("Failed to allocate direction map");
+        exit(EXIT_FAILURE);
+    }
+
+    return map;
+}
+
+void freeDirectionMap(DirectionMap_t *map) {
+    free(map->bits);
+    map->bits = NULL;
+    map->sz = 0;
+}
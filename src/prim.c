@@ -1,289 +1,154 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <time.h>
 
 #include "MazeTools.h"
+#include "mazeBits.h"
 #include "prim.h"
-
-static bool addElement(Tree_t *list, size_t sz, Tree_t element) {
-    bool found = false;
-
-    for (size_t i = 0; i < sz && !found; i++) {
-        found = list[i].val == element.val;
+#include "stepObserver.h"
+
+// The cells next to the maze that are not in it yet. The cells are kept
+// densely so one is drawn in O(1), and a bitmap tells if a cell is already
+// in them so no cell is added twice.
+typedef struct {
+    uint32_t *cells;
+    uint64_t *members;
+    size_t count;
+} Frontier_t;
+
+static Frontier_t createFrontier(size_t sz) {
+    Frontier_t frontier = {.cells = NULL, .members = NULL, .count = 0};
+
+    frontier.cells = malloc(sizeof(*frontier.cells) * (sz ? sz : 1));
+    frontier.members = calloc((sz + 63) / 64 ? (sz + 63) / 64 : 1,
+                              sizeof(*frontier.members));
+    if (frontier.cells == NULL || frontier.members == NULL) {
+        perror("Failed to allocate Prim frontier");
+        exit(EXIT_FAILURE);
     }
 
-    if (!found) {
-        list[sz] = element;
-    }
-
-    return !found;
+    return frontier;
 }
 
+static void freeFrontier(Frontier_t *frontier) {
+    free(frontier->cells);
+    free(frontier->members);
+    frontier->cells = NULL;
+    frontier->members = NULL;
+    frontier->count = 0;
+}
 
-void primGen(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t startI;
-    ssize_t frontierSz = 0;
-    Point_t cellPt;
-    Tree_t *trees = malloc(sizeof(*trees) * sz);
-    Tree_t *frontiers = malloc(sizeof(*trees) * sz);
-
-    for (size_t i = 0; i < sz; i++) {
-        trees[i] = (Tree_t){i, NULL, NULL, NULL};
-    }
-
-    srand(time(NULL));
-
-    // random starting cell
-    startI = rand() % sz;
-
-    // Get initial frontiers
-	cellPt = indexToPoint(startI, maze->width);
-
-    if (cellPt.x > 0) {
-        frontiers[frontierSz++] = trees[startI - 1];
-    }
-
-    if (cellPt.x < maze->width - 1) {
-        frontiers[frontierSz++] = trees[startI + 1];
-    }
-
-    if (cellPt.y > 0) {
-        frontiers[frontierSz++] = trees[startI - maze->width];
-    }
-
-    if (cellPt.y < maze->height - 1) {
-        frontiers[frontierSz++] = trees[startI + maze->width];
+// Adds a cell to the frontier unless it is in it already.
+static bool addFrontier(Frontier_t *frontier, uint32_t i) {
+    if (bitsTest(frontier->members, i)) {
+        return false;
     }
 
-    // evaluate frontiers
-    while (frontierSz > 0) {
-        ssize_t randI = rand() % frontierSz;
-        size_t frontierI = frontiers[randI].val;
-        Tree_t potCells[4];
-        size_t potSz = 0;
-        size_t randPotCellI = 0;
-        Point_t cellPt2 = {0, 0};
-		Direction_t dir;
-
-		cellPt = indexToPoint(frontierI, maze->width);
-
-        // find cells in maze adjacent to the current frontier cell
-        if (cellPt.x > 0) {
-            size_t i = frontierI - 1;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                }
-            }
-        }
-
-        if (cellPt.x < maze->width - 1) {
-            size_t i = frontierI + 1;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                }
-            }
-        }
-
-        if (cellPt.y > 0) {
-            size_t i = frontierI - maze->width;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                }
-            }
-        }
-
-        if (cellPt.y < maze->height - 1) {
-            size_t i = frontierI + maze->width;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                }
-            }
-        }
-
-        // pick a random maze cell
-        randPotCellI = potCells[rand() % potSz].val;
-
-        // join edges
-		cellPt2 = indexToPoint(randPotCellI, maze->width);
+    bitsSet(frontier->members, i);
+    frontier->cells[frontier->count++] = i;
 
+    return true;
+}
 
-        if (cellPt.x != cellPt2.x) {
-			dir = cellPt.x > cellPt2.x ? left : right;
-        } else {
-			dir = cellPt.y > cellPt2.y ? up : down;
-        }
-
-		mazeConnectCells(maze, frontierI, randPotCellI, dir);
-
-        joinTrees(trees + startI, trees + frontierI);
-
-        // remove frontier
-        for (ssize_t i = randI; i < frontierSz - 1; i++) {
-            frontiers[i] = frontiers[i + 1];
-        }
-        frontierSz--;
-    }
-
-	free(trees);
-	free(frontiers);
+// Removes the cell at slot of the frontier by moving the last cell into it.
+static uint32_t removeFrontier(Frontier_t *frontier, size_t slot) {
+    uint32_t i = frontier->cells[slot];
 
-    // assign start and stop location
-	assignRandomStartAndStop(maze);
+    frontier->cells[slot] = frontier->cells[--frontier->count];
+    bitsClear(frontier->members, i);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    return i;
 }
 
-void primGenWithSteps(Maze_t *maze, FILE *restrict stream) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     size_t sz = maze->width * maze->height;
-    size_t startI;
-    ssize_t frontierSz = 0;
+    size_t startI, dirSz;
+    Frontier_t frontier = createFrontier(sz);
+    uint64_t *inMaze = calloc((sz + 63) / 64 ? (sz + 63) / 64 : 1,
+                              sizeof(*inMaze));
     Point_t cellPt;
-    Tree_t *trees = malloc(sizeof(*trees) * sz);
-    Tree_t *frontiers = malloc(sizeof(*trees) * sz);
+    Direction_t dir[4];
 
-    for (size_t i = 0; i < sz; i++) {
-        trees[i] = (Tree_t){i, NULL, NULL, NULL};
+    if (inMaze == NULL) {
+        perror("Failed to allocate Prim cells");
+        exit(EXIT_FAILURE);
     }
 
-    srand(time(NULL));
-
     // random starting cell
-    startI = rand() % sz;
+    startI = mazeRngBelow(rng, sz);
+    bitsSet(inMaze, startI);
 
-    // Get initial frontiers
-	cellPt = indexToPoint(startI, maze->width);
+    // the neighbours of the start are the first frontier
+    cellPt = indexToPoint(startI, maze->width);
+    dirSz = getValidDirections(cellPt, *maze, dir);
 
-    if (cellPt.x > 0) {
-        frontiers[frontierSz++] = trees[startI - 1];
-        maze->cells[startI - 1].observing = 1;
-    }
+    for (size_t d = 0; d < dirSz; d++) {
+        size_t i = pointToIndex(pointShift(cellPt, dir[d]), maze->width);
 
-    if (cellPt.x < maze->width - 1) {
-        frontiers[frontierSz++] = trees[startI + 1];
-        maze->cells[startI + 1].observing = 1;
-    }
-
-    if (cellPt.y > 0) {
-        frontiers[frontierSz++] = trees[startI - maze->width];
-        maze->cells[startI - maze->width].observing = 1;
-    }
-
-    if (cellPt.y < maze->height - 1) {
-        frontiers[frontierSz++] = trees[startI + maze->width];
-        maze->cells[startI + maze->width].observing = 1;
+        addFrontier(&frontier, i);
+        if (observer) {
+            maze->cells[i].observing = 1;
+            observeCell(observer, maze, i);
+        }
     }
 
-    fprintStep(stream, maze);
+    observeFrame(observer, maze, renderPlain);
 
     // evaluate frontiers
-    while (frontierSz != 0) {
-        size_t randI = rand() % frontierSz;
-        size_t frontierI = frontiers[randI].val;
-        Tree_t potCells[4];
+    while (frontier.count > 0) {
+        size_t frontierI = removeFrontier(&frontier,
+                                          mazeRngBelow(rng, frontier.count));
         size_t potSz = 0;
-        size_t randPotCellI = 0;
-        Point_t cellPt2 = {0, 0};
-		Direction_t dir;
-
-		cellPt = indexToPoint(frontierI, maze->width);
-
-        // find cells in maze adjacent to the current frontier cell
-        if (cellPt.x > 0) {
-            size_t i = frontierI - 1;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                    maze->cells[i].observing = 1;
-                }
+        size_t joinI;
+        Direction_t potDirs[4];
+        Direction_t joinDir;
+
+        cellPt = indexToPoint(frontierI, maze->width);
+        dirSz = getValidDirections(cellPt, *maze, dir);
+
+        // the neighbours in the maze could be joined, the others are frontier
+        for (size_t d = 0; d < dirSz; d++) {
+            size_t i = pointToIndex(pointShift(cellPt, dir[d]), maze->width);
+
+            if (bitsTest(inMaze, i)) {
+                potDirs[potSz++] = dir[d];
+            } else if (addFrontier(&frontier, i) && observer) {
+                maze->cells[i].observing = 1;
+                observeCell(observer, maze, i);
             }
         }
 
-        if (cellPt.x < maze->width - 1) {
-            size_t i = frontierI + 1;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                    maze->cells[i].observing = 1;
-                }
-            }
-        }
-
-        if (cellPt.y > 0) {
-            size_t i = frontierI - maze->width;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                    maze->cells[i].observing = 1;
-                }
-            }
-        }
-
-        if (cellPt.y < maze->height - 1) {
-            size_t i = frontierI + maze->width;
-            if (isSameTree(trees + startI, trees + i)) {
-                potCells[potSz++] = trees[i];
-            } else {
-                if (addElement(frontiers, frontierSz, trees[i])) {
-                    frontierSz++;
-                    maze->cells[i].observing = 1;
-                }
-            }
-        }
-
-        // pick a random maze cell
-        randPotCellI = potCells[rand() % potSz].val;
+        // join a random maze cell
+        joinDir = potDirs[mazeRngBelow(rng, potSz)];
+        joinI = pointToIndex(pointShift(cellPt, joinDir), maze->width);
 
-        // join edges
-		cellPt2 = indexToPoint(randPotCellI, maze->width);
-
-        if (cellPt.x != cellPt2.x) {
-			dir = cellPt.x > cellPt2.x ? left : right;
-        } else {
-			dir = cellPt.y > cellPt2.y ? up : down;
+        mazeConnectCells(maze, frontierI, joinI, joinDir);
+        bitsSet(inMaze, frontierI);
+        if (observer) {
+            maze->cells[frontierI].observing = 0;
         }
+        observeCell(observer, maze, frontierI);
+        observeCell(observer, maze, joinI);
 
-		mazeConnectCells(maze, frontierI, randPotCellI, dir);
-        maze->cells[frontierI].observing = 0;
-
-        joinTrees(trees + startI, trees + frontierI);
-
-        fprintStep(stream, maze);
-
-        // remove frontier
-        for (ssize_t i = randI; i < frontierSz - 1; i++) {
-            frontiers[i] = frontiers[i + 1];
-        }
-        frontierSz--;
+        observeFrame(observer, maze, renderPlain);
     }
 
-	free(trees);
-	free(frontiers);
+    freeFrontier(&frontier);
+    free(inMaze);
 
     // assign start and stop location
-	assignRandomStartAndStopWithSteps(maze, stream);
+    assignRandomStartAndStopObserved(maze, rng, observer);
+
+    // write the finished maze
+    observeDone(observer, maze);
+}
+
+void primGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void primGenObserved(Maze_t *maze, MazeRng_t *rng,
+                     const StepObserver_t *observer) {
+    generate(maze, rng, observer);
 }
@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "priorityQueue.h"
+
+static void *allocOrDie(size_t sz) {
+    void *ptr = malloc(sz);
+
+    if (ptr == NULL && sz != 0) {
+        perror("Failed to allocate queue");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
+
+RingQueue_t createRingQueue(size_t sz) {
+    RingQueue_t queue = {.indexes = NULL, .head = 0, .count = 0, .sz = 1};
+
+    while (queue.sz < sz) {
+        queue.sz *= 2;
+    }
+
+    queue.indexes = allocOrDie(sizeof(*queue.indexes) * queue.sz);
+
+    return queue;
+}
+
+void ringQueuePush(RingQueue_t *queue, uint32_t index) {
+    if (queue->count == queue->sz) {
+        size_t sz = queue->sz * 2;
+        uint32_t *indexes = allocOrDie(sizeof(*indexes) * sz);
+        size_t tail = queue->sz - queue->head;
+
+        // unwrap the old ring so the new one starts at zero
+        memcpy(indexes, queue->indexes + queue->head, sizeof(*indexes) * tail);
+        memcpy(indexes + tail, queue->indexes,
+               sizeof(*indexes) * queue->head);
+
+        free(queue->indexes);
+        queue->indexes = indexes;
+        queue->head = 0;
+        queue->sz = sz;
+    }
+
+    queue->indexes[(queue->head + queue->count++) & (queue->sz - 1)] = index;
+}
+
+uint32_t ringQueuePop(RingQueue_t *queue) {
+    uint32_t index;
+
+    if (queue->count == 0) {
+        return QUEUE_INVALID_INDEX;
+    }
+
+    index = queue->indexes[queue->head];
+    queue->head = (queue->head + 1) & (queue->sz - 1);
+    queue->count--;
+
+    return index;
+}
+
+void clearRingQueue(RingQueue_t *queue) {
+    queue->head = 0;
+    queue->count = 0;
+}
+
+void freeRingQueue(RingQueue_t *queue) {
+    free(queue->indexes);
+    queue->indexes = NULL;
+    queue->head = 0;
+    queue->count = 0;
+    queue->sz = 0;
+}
+
+// a comes before b if it has a lower key, or the same key and was pushed first
+static inline bool heapLess(HeapNode_t a, HeapNode_t b) {
+    return a.key < b.key || (a.key == b.key && a.seq < b.seq);
+}
+
+static void siftUp(IndexedHeap_t *heap, size_t i) {
+    HeapNode_t node = heap->nodes[i];
+
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+
+        if (!heapLess(node, heap->nodes[parent])) {
+            break;
+        }
+
+        heap->nodes[i] = heap->nodes[parent];
+        heap->pos[heap->nodes[i].index] = i + 1;
+        i = parent;
+    }
+
+    heap->nodes[i] = node;
+    heap->pos[node.index] = i + 1;
+}
+
+static void siftDown(IndexedHeap_t *heap, size_t i) {
+    HeapNode_t node = heap->nodes[i];
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+
+        if (child >= heap->count) {
+            break;
+        }
+
+        if (child + 1 < heap->count &&
+            heapLess(heap->nodes[child + 1], heap->nodes[child])) {
+            child++;
+        }
+
+        if (!heapLess(heap->nodes[child], node)) {
+            break;
+        }
+
+        heap->nodes[i] = heap->nodes[child];
+        heap->pos[heap->nodes[i].index] = i + 1;
+        i = child;
+    }
+
+    heap->nodes[i] = node;
+    heap->pos[node.index] = i + 1;
+}
+
+IndexedHeap_t createIndexedHeap(size_t sz) {
+    IndexedHeap_t heap = {.nodes = NULL, .pos = NULL, .count = 0,
+                          .nodeSz = 64, .sz = sz, .seq = 0};
+
+    // calloc leaves the positions of untouched cells unmapped
+    heap.nodes = allocOrDie(sizeof(*heap.nodes) * heap.nodeSz);
+    heap.pos = calloc(sz ? sz : 1, sizeof(*heap.pos));
+    if (heap.pos == NULL) {
+        perror("Failed to allocate queue");
+        exit(EXIT_FAILURE);
+    }
+
+    return heap;
+}
+
+bool indexedHeapPush(IndexedHeap_t *heap, uint32_t index, uint64_t key) {
+    size_t i = heap->pos[index];
+
+    if (i == 0) {
+        if (heap->count == heap->nodeSz) {
+            heap->nodeSz *= 2;
+            heap->nodes =
+                realloc(heap->nodes, sizeof(*heap->nodes) * heap->nodeSz);
+            if (heap->nodes == NULL) {
+                perror("Failed to allocate queue");
+                exit(EXIT_FAILURE);
+            }
+        }
+        i = heap->count++;
+    } else if (key >= heap->nodes[--i].key) {
+        return false;
+    }
+
+    // a lowered key is treated like a fresh push so ties stay FIFO
+    heap->nodes[i] = (HeapNode_t){key, heap->seq++, index};
+    siftUp(heap, i);
+
+    return true;
+}
+
+uint32_t indexedHeapPop(IndexedHeap_t *heap, uint64_t *key) {
+    HeapNode_t top;
+
+    if (heap->count == 0) {
+        return QUEUE_INVALID_INDEX;
+    }
+
+    top = heap->nodes[0];
+    heap->pos[top.index] = 0;
+
+    if (--heap->count > 0) {
+        heap->nodes[0] = heap->nodes[heap->count];
+        siftDown(heap, 0);
+    }
+
+    if (key) {
+        *key = top.key;
+    }
+
+    return top.index;
+}
+
+bool indexedHeapContains(const IndexedHeap_t *heap, uint32_t index) {
+    return heap->pos[index] != 0;
+}
+
+void clearIndexedHeap(IndexedHeap_t *heap) {
+    // only the queued indexes need their position reset
+    for (size_t i = 0; i < heap->count; i++) {
+        heap->pos[heap->nodes[i].index] = 0;
+    }
+
+    heap->count = 0;
+    heap->seq = 0;
+}
+
+void freeIndexedHeap(IndexedHeap_t *heap) {
+    free(heap->nodes);
+    free(heap->pos);
+    heap->nodes = NULL;
+    heap->pos = NULL;
+    heap->count = 0;
+    heap->nodeSz = 0;
+    heap->sz = 0;
+}
+
+BucketQueue_t createBucketQueue(size_t maxStep) {
+    BucketQueue_t queue = {.buckets = NULL, .bucketCount = maxStep + 1,
+                           .key = 0, .count = 0};
+
+    queue.buckets = allocOrDie(sizeof(*queue.buckets) * queue.bucketCount);
+
+    for (size_t i = 0; i < queue.bucketCount; i++) {
+        queue.buckets[i] = (Bucket_t){NULL, 0, 0, 0};
+    }
+
+    return queue;
+}
+
+void bucketQueuePush(BucketQueue_t *queue, uint32_t index, uint64_t key) {
+    Bucket_t *bucket;
+
+    // the first push of an empty queue sets where the ring starts
+    if (queue->count == 0) {
+        queue->key = key;
+    }
+
+    bucket = queue->buckets + key % queue->bucketCount;
+
+    if (bucket->count == bucket->sz) {
+        bucket->sz = bucket->sz == 0 ? 64 : bucket->sz * 2;
+        bucket->indexes =
+            realloc(bucket->indexes, sizeof(*bucket->indexes) * bucket->sz);
+        if (bucket->indexes == NULL) {
+            perror("Failed to allocate queue");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bucket->indexes[bucket->count++] = index;
+    queue->count++;
+}
+
+uint32_t bucketQueuePop(BucketQueue_t *queue, uint64_t *key) {
+    Bucket_t *bucket;
+    uint32_t index;
+
+    if (queue->count == 0) {
+        return QUEUE_INVALID_INDEX;
+    }
+
+    bucket = queue->buckets + queue->key % queue->bucketCount;
+
+    while (bucket->count == 0) {
+        queue->key++;
+        bucket = queue->buckets + queue->key % queue->bucketCount;
+    }
+
+    index = bucket->indexes[bucket->head++];
+    queue->count--;
+
+    // drained buckets are rewound so they never grow past their peak
+    if (bucket->head == bucket->count) {
+        bucket->head = 0;
+        bucket->count = 0;
+    }
+
+    if (key) {
+        *key = queue->key;
+    }
+
+    return index;
+}
+
+void clearBucketQueue(BucketQueue_t *queue) {
+    for (size_t i = 0; i < queue->bucketCount; i++) {
+        queue->buckets[i].head = 0;
+        queue->buckets[i].count = 0;
+    }
+
+    queue->key = 0;
+    queue->count = 0;
+}
+
+void freeBucketQueue(BucketQueue_t *queue) {
+    for (size_t i = 0; i < queue->bucketCount; i++) {
+        free(queue->buckets[i].indexes);
+    }
+
+    free(queue->buckets);
+    queue->buckets = NULL;
+    queue->bucketCount = 0;
+    queue->count = 0;
+}
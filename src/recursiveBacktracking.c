@@ -1,88 +1,159 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "MazeTools.h"
 #include "recursiveBacktracking.h"
+#include "stepObserver.h"
+
+// The cells on the path being carved, most recent last, with the directions
+// each has left to try packed in a byte: the count in the low 2 bits, then
+// up to 3 directions of 2 bits, next first. The way back to the cell before
+// is always visited, so it is never kept. Only the first cell has no cell
+// before it and can have 4 directions, so it is never put on the stack.
+typedef struct {
+    uint32_t *cells;
+    uint8_t *dirs;
+    size_t count;
+} CarveStack_t;
+
+static CarveStack_t createCarveStack(size_t sz) {
+    CarveStack_t stack = {.cells = NULL, .dirs = NULL, .count = 0};
+
+    // every cell is carved into once, so the path is never longer
+    stack.cells = malloc(sizeof(*stack.cells) * (sz ? sz : 1));
+    stack.dirs = malloc(sizeof(*stack.dirs) * (sz ? sz : 1));
+    if (stack.cells == NULL || stack.dirs == NULL) {
+        perror("Failed to allocate backtracking stack");
+        exit(EXIT_FAILURE);
+    }
 
-static void recursive(Maze_t *maze, Point_t point) {
-    Direction_t dir[4];
-    size_t dirSz = getRandomDirections(point, *maze, dir);
-    size_t index = pointToIndex(point, maze->width);
+    return stack;
+}
 
-    maze->cells[index].visited = 1;
+static void freeCarveStack(CarveStack_t *stack) {
+    free(stack->cells);
+    free(stack->dirs);
+    stack->cells = NULL;
+    stack->dirs = NULL;
+    stack->count = 0;
+}
+
+// Packs the directions of a cell but the one it was carved from.
+static uint8_t packDirections(const Direction_t dir[4], size_t dirSz,
+                              Direction_t from) {
+    uint8_t packed = 0;
+    uint8_t count = 0;
 
     for (size_t i = 0; i < dirSz; i++) {
-        Point_t newPoint = pointShift(point, dir[i]);
-        size_t newIndex = pointToIndex(newPoint, maze->width);
-        if (!maze->cells[newIndex].visited) {
-			mazeConnectCells(maze, index, newIndex, dir[i]);
-            maze->cells[newIndex].visited = 1;
-            recursive(maze, newPoint);
+        if (dir[i] != from) {
+            packed |= dir[i] << (2 + 2 * count++);
         }
     }
-}
 
-static void recursiveWithSteps(Maze_t *maze, Point_t point,
-                               FILE *restrict stream) {
-    Direction_t dir[4];
-    size_t dirSz = getRandomDirections(point, *maze, dir);
-    size_t index = pointToIndex(point, maze->width);
+    return packed | count;
+}
 
-	fprintStepIgnoreVisted(stream, maze);
+// Takes the next direction to try off the top of the stack.
+static Direction_t popDirection(CarveStack_t *stack) {
+    uint8_t *packed = &stack->dirs[stack->count - 1];
+    Direction_t dir = (*packed >> 2) & 3;
 
-    maze->cells[index].visited = 1;
+    *packed = ((*packed >> 2) & ~3) | ((*packed & 3) - 1);
 
-    for (size_t i = 0; i < dirSz; i++) {
-        Point_t newPoint = pointShift(point, dir[i]);
-        size_t newIndex = pointToIndex(newPoint, maze->width);
-        if (!maze->cells[newIndex].visited) {
-			mazeConnectCells(maze, index, newIndex, dir[i]);
-            maze->cells[newIndex].visited = 1;
-            recursiveWithSteps(maze, newPoint, stream);
-        }
-    }
+    return dir;
 }
 
-void recursiveBacktracking(Maze_t *maze) {
-    Point_t startCell;
+// Visits a cell and draws the order its neighbours are tried in.
+OBSERVED_INLINE size_t enterCell(Maze_t *maze, Point_t point,
+                                 Direction_t dir[4], MazeRng_t *rng,
+                                 const StepObserver_t *observer) {
+    size_t dirSz = getRandomDirections(point, *maze, dir, rng);
+    size_t index = pointToIndex(point, maze->width);
 
-    srand(time(NULL));
+    observeFrame(observer, maze, renderIgnoreVisited);
 
-    startCell.x = rand() % maze->width;
-    startCell.y = rand() % maze->height;
+    maze->cells[index].visited = 1;
+    observeCell(observer, maze, index);
 
-    recursive(maze, startCell);
+    return dirSz;
+}
 
-	for (size_t i = 0; i < maze->width * maze->height; i++) {
-		maze->cells[i].visited = 0;
-	}
+// Carves from a cell to its neighbour in a direction, if it is unvisited,
+// and puts the neighbour on the stack.
+OBSERVED_INLINE void carve(Maze_t *maze, CarveStack_t *stack, Point_t point,
+                           Direction_t dir, MazeRng_t *rng,
+                           const StepObserver_t *observer) {
+    Point_t newPoint = pointShift(point, dir);
+    size_t index = pointToIndex(point, maze->width);
+    size_t newIndex = pointToIndex(newPoint, maze->width);
+    Direction_t newDir[4];
+    size_t newDirSz;
 
-    // assign start and stop location
-	assignRandomStartAndStop(maze);
+    if (maze->cells[newIndex].visited) {
+        return;
+    }
+
+    mazeConnectCells(maze, index, newIndex, dir);
+    maze->cells[newIndex].visited = 1;
+    observeCell(observer, maze, index);
+    observeCell(observer, maze, newIndex);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    newDirSz = enterCell(maze, newPoint, newDir, rng, observer);
+    stack->cells[stack->count] = newIndex;
+    stack->dirs[stack->count] =
+        packDirections(newDir, newDirSz, oppositeDirection(dir));
+    stack->count++;
 }
 
-void recursiveBacktrackingWithSteps(Maze_t *maze, FILE *restrict stream) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
+    CarveStack_t stack = createCarveStack(maze->width * maze->height);
     Point_t startCell;
+    Direction_t dir[4];
+    size_t dirSz;
 
-    srand(time(NULL));
+    startCell.x = mazeRngBelow(rng, maze->width);
+    startCell.y = mazeRngBelow(rng, maze->height);
 
-    startCell.x = rand() % maze->width;
-    startCell.y = rand() % maze->height;
+    // the cells are tried depth first, in the order the recursion took
+    dirSz = enterCell(maze, startCell, dir, rng, observer);
+    for (size_t i = 0; i < dirSz; i++) {
+        carve(maze, &stack, startCell, dir[i], rng, observer);
+
+        while (stack.count > 0) {
+            if ((stack.dirs[stack.count - 1] & 3) == 0) {
+                stack.count--;
+            } else {
+                Point_t point =
+                    indexToPoint(stack.cells[stack.count - 1], maze->width);
+
+                carve(maze, &stack, point, popDirection(&stack), rng,
+                      observer);
+            }
+        }
+    }
 
-    recursiveWithSteps(maze, startCell, stream);
+    freeCarveStack(&stack);
 
 	for (size_t i = 0; i < maze->width * maze->height; i++) {
 		maze->cells[i].visited = 0;
+		observeCell(observer, maze, i);
 	}
 
     // assign start and stop location
-	assignRandomStartAndStopWithSteps(maze, stream);
+	assignRandomStartAndStopObserved(maze, rng, observer);
+
+    // write the finished maze
+    observeDone(observer, maze);
+}
+
+void recursiveBacktracking(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void recursiveBacktrackingObserved(Maze_t *maze, MazeRng_t *rng,
+                                   const StepObserver_t *observer) {
+    generate(maze, rng, observer);
 }
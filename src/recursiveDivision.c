@@ -1,15 +1,60 @@
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
+#include <unistd.h>
 
 #include "MazeTools.h"
 #include "recursiveDivision.h"
+#include "stepObserver.h"
+
+// Rectangles of at least this many cells give each half a generator of its
+// own, seeded from theirs, and hand the second half to the pool. The halves
+// then draw the same numbers whichever thread takes them.
+#define DIVIDE_TASK_CELLS (1 << 16)
+
+// A rectangle waiting to be divided.
+typedef struct {
+	Point_t topLeft;
+	Point_t bottomRight;
+	MazeRng_t rng;
+} DivideTask_t;
+
+// The threads dividing a maze. Rectangles are taken newest first, so a
+// thread keeps dividing near where it left off.
+typedef struct {
+	Maze_t *maze;
+	pthread_mutex_t lock;
+	pthread_cond_t ready;
+	DivideTask_t *tasks;
+	size_t count;
+	size_t sz;
+	size_t busy;
+} DividePool_t;
+
+static void pushTask(DividePool_t *pool, DivideTask_t task) {
+	pthread_mutex_lock(&pool->lock);
+	if (pool->count == pool->sz) {
+		pool->sz = pool->sz ? pool->sz * 2 : 64;
+		pool->tasks = realloc(pool->tasks, sizeof(*pool->tasks) * pool->sz);
+		if (pool->tasks == NULL) {
+			perror("Failed to allocate division tasks");
+			exit(EXIT_FAILURE);
+		}
+	}
+	pool->tasks[pool->count++] = task;
+	pthread_cond_signal(&pool->ready);
+	pthread_mutex_unlock(&pool->lock);
+}
 
-static void recursive(Maze_t *maze, Point_t topLeft, Point_t bottomRight) {
+static void recursive(Maze_t *maze, Point_t topLeft, Point_t bottomRight,
+                      MazeRng_t *rng, DividePool_t *pool,
+                      const StepObserver_t *observer) {
 	size_t width = bottomRight.x - topLeft.x + 1;
 	size_t height = bottomRight.y - topLeft.y + 1;
 	size_t x, y;
+	Point_t firstBottomRight, secondTopLeft;
 
 	if (width == 1 || height == 1) {
 		return;
@@ -17,114 +62,148 @@ static void recursive(Maze_t *maze, Point_t topLeft, Point_t bottomRight) {
 
 	// The grid should bisect the longest direction.
 	// If they are the same, the choice is random.
-	if ((width == height && rand() % 2 == 0) || height > width) { // bissect horizontally
+	if ((width == height && mazeRngCoin(rng)) || height > width) { // bissect horizontally
 		// place walls along the row
-		y = rand() % (height - 1) + topLeft.y;
+		y = mazeRngBelow(rng, height - 1) + topLeft.y;
 
 		for (size_t i = topLeft.x; i <= bottomRight.x; i++) {
-			maze->cells[y * maze->width + i].bottom = 1;	
-			maze->cells[(y + 1) * maze->width + i].top = 1;	
+			maze->cells[y * maze->width + i].bottom = 1;
+			maze->cells[(y + 1) * maze->width + i].top = 1;
+			observeWall(observer, maze, (Point_t){i, y}, down);
 		}
 
+		observeFrame(observer, maze, renderPlain);
+
 		// remove one wall
-		x = rand() % width + topLeft.x;
+		x = mazeRngBelow(rng, width) + topLeft.x;
 
-		maze->cells[y * maze->width + x].bottom = 0;	
-		maze->cells[(y + 1) * maze->width + x].top = 0;	
+		maze->cells[y * maze->width + x].bottom = 0;
+		maze->cells[(y + 1) * maze->width + x].top = 0;
+		observeWall(observer, maze, (Point_t){x, y}, down);
 
-		// resolve two areas
-		recursive(maze, topLeft, (Point_t){bottomRight.x, y});
+		observeFrame(observer, maze, renderPlain);
 
-		recursive(maze, (Point_t){topLeft.x, y + 1}, bottomRight);
+		firstBottomRight = (Point_t){bottomRight.x, y};
+		secondTopLeft = (Point_t){topLeft.x, y + 1};
 	} else { // bissect virtically
 
 		// place walls along the collumn
-		x = rand() % (width - 1) + topLeft.x;
+		x = mazeRngBelow(rng, width - 1) + topLeft.x;
 
 		for (size_t i = topLeft.y; i <= bottomRight.y; i++) {
-			maze->cells[i * maze->width + x].right = 1;	
-			maze->cells[i * maze->width + x + 1].left = 1;	
+			maze->cells[i * maze->width + x].right = 1;
+			maze->cells[i * maze->width + x + 1].left = 1;
+			observeWall(observer, maze, (Point_t){x, i}, right);
 		}
 
+		observeFrame(observer, maze, renderPlain);
+
 		// remove one wall
-		y = rand() % height + topLeft.y;
+		y = mazeRngBelow(rng, height) + topLeft.y;
 
-		maze->cells[y * maze->width + x].right = 0;	
-		maze->cells[y * maze->width + x + 1].left = 0;	
+		maze->cells[y * maze->width + x].right = 0;
+		maze->cells[y * maze->width + x + 1].left = 0;
+		observeWall(observer, maze, (Point_t){x, y}, right);
 
-		// resolve two areas
-		recursive(maze, topLeft, (Point_t){x, bottomRight.y});
+		observeFrame(observer, maze, renderPlain);
 
-		recursive(maze, (Point_t){x + 1, topLeft.y}, bottomRight);
+		firstBottomRight = (Point_t){x, bottomRight.y};
+		secondTopLeft = (Point_t){x + 1, topLeft.y};
 	}
-}
 
-static void recursiveSteps(Maze_t *maze, Point_t topLeft, Point_t bottomRight, FILE *restrict stream) {
-	size_t width = bottomRight.x - topLeft.x + 1;
-	size_t height = bottomRight.y - topLeft.y + 1;
-	size_t x, y;
+	// resolve two areas
+	if (width * height >= DIVIDE_TASK_CELLS) {
+		MazeRng_t firstRng = createMazeRng(mazeRngNext(rng));
+		DivideTask_t second = {secondTopLeft, bottomRight,
+		                       createMazeRng(mazeRngNext(rng))};
 
-	if (width == 1 || height == 1) {
-		return;
+		if (pool) {
+			pushTask(pool, second);
+		}
+		recursive(maze, topLeft, firstBottomRight, &firstRng, pool, observer);
+		if (!pool) {
+			recursive(maze, second.topLeft, second.bottomRight, &second.rng,
+			          NULL, observer);
+		}
+	} else {
+		recursive(maze, topLeft, firstBottomRight, rng, pool, observer);
+		recursive(maze, secondTopLeft, bottomRight, rng, pool, observer);
 	}
+}
 
-	// The grid should bisect the longest direction.
-	// If they are the same, the choice is random.
-	if ((width == height && rand() % 2 == 0) || height > width) { // bissect horizontally
-		// place walls along the row
-		y = rand() % (height - 1) + topLeft.y;
+// Divides rectangles until none are left and no thread can add more.
+static void *divideWorker(void *arg) {
+	DividePool_t *pool = arg;
+	DivideTask_t task;
 
-		for (size_t i = topLeft.x; i <= bottomRight.x; i++) {
-			maze->cells[y * maze->width + i].bottom = 1;	
-			maze->cells[(y + 1) * maze->width + i].top = 1;	
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (pool->count == 0 && pool->busy > 0) {
+			pthread_cond_wait(&pool->ready, &pool->lock);
+		}
+		if (pool->count == 0) {
+			break;
 		}
 
-		fprintStep(stream, maze);
+		task = pool->tasks[--pool->count];
+		pool->busy++;
+		pthread_mutex_unlock(&pool->lock);
 
-		// remove one wall
-		x = rand() % width + topLeft.x;
+		recursive(pool->maze, task.topLeft, task.bottomRight, &task.rng, pool,
+		          NULL);
 
-		maze->cells[y * maze->width + x].bottom = 0;	
-		maze->cells[(y + 1) * maze->width + x].top = 0;	
+		pthread_mutex_lock(&pool->lock);
+		pool->busy--;
+	}
 
-		fprintStep(stream, maze);
+	// wake the threads still waiting, there is nothing left for them
+	pthread_cond_broadcast(&pool->ready);
+	pthread_mutex_unlock(&pool->lock);
 
-		// resolve two areas
-		recursiveSteps(maze, topLeft, (Point_t){bottomRight.x, y}, stream);
+	return NULL;
+}
 
-		recursiveSteps(maze, (Point_t){topLeft.x, y + 1}, bottomRight, stream);
-	} else { // bissect virtically
+// Divides a maze with a pool of threads, this one included.
+static void divideParallel(Maze_t *maze, MazeRng_t *rng, size_t threads) {
+	DividePool_t pool = {.maze = maze, .tasks = NULL, .count = 0, .sz = 0,
+	                     .busy = 0};
+	pthread_t *workers = malloc(sizeof(*workers) * threads);
+	size_t started = 0;
 
-		// place walls along the collumn
-		x = rand() % (width - 1) + topLeft.x;
+	if (workers == NULL) {
+		perror("Failed to allocate division threads");
+		exit(EXIT_FAILURE);
+	}
 
-		for (size_t i = topLeft.y; i <= bottomRight.y; i++) {
-			maze->cells[i * maze->width + x].right = 1;	
-			maze->cells[i * maze->width + x + 1].left = 1;	
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.ready, NULL);
+	pushTask(&pool, (DivideTask_t){{0, 0},
+	                               {maze->width - 1, maze->height - 1},
+	                               *rng});
+
+	// fewer threads only make it slower, never a different maze
+	for (size_t i = 1; i < threads; i++) {
+		if (pthread_create(&workers[started], NULL, divideWorker, &pool) ==
+		    0) {
+			started++;
 		}
-
-		fprintStep(stream, maze);
-
-		// remove one wall
-		y = rand() % height + topLeft.y;
-
-		maze->cells[y * maze->width + x].right = 0;	
-		maze->cells[y * maze->width + x + 1].left = 0;	
-
-		fprintStep(stream, maze);
-
-		// resolve two areas
-		recursiveSteps(maze, topLeft, (Point_t){x, bottomRight.y}, stream);
-
-		recursiveSteps(maze, (Point_t){x + 1, topLeft.y}, bottomRight, stream);
 	}
+	divideWorker(&pool);
+	for (size_t i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+
+	pthread_mutex_destroy(&pool.lock);
+	pthread_cond_destroy(&pool.ready);
+	free(pool.tasks);
+	free(workers);
 }
 
-void recursiveDivisionGen(Maze_t *maze) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng, size_t threads,
+                              const StepObserver_t *observer) {
 	Point_t topLeft = {0, 0};
 	Point_t bottomRight = {maze->width - 1, maze->height - 1};
-
-    srand(time(NULL));
+	MazeRng_t divideRng;
 
 	// remove all walls
 	for (size_t i = 0; i < maze->width * maze->height; i++) {
@@ -132,6 +211,7 @@ void recursiveDivisionGen(Maze_t *maze) {
 		maze->cells[i].right = 0;
 		maze->cells[i].top = 0;
 		maze->cells[i].bottom = 0;
+		observeCell(observer, maze, i);
 	}
 
 	for (size_t i = 0; i < maze->width; i++) {
@@ -144,47 +224,41 @@ void recursiveDivisionGen(Maze_t *maze) {
 		maze->cells[maze->width * i + maze->width - 1].right = 1;
 	}
 
-	recursive(maze, topLeft, bottomRight);
-
-    // assign start and stop location
-    assignRandomStartAndStop(maze);
+	observeFrame(observer, maze, renderPlain);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-}
+	// the walls come from a generator of their own, so the ends drawn after
+	// do not depend on how the rectangles were shared out
+	divideRng = createMazeRng(mazeRngNext(rng));
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
 
-void recursiveDivisionGenWithSteps(Maze_t *maze, FILE *restrict stream) {
-	Point_t topLeft = {0, 0};
-	Point_t bottomRight = {maze->width - 1, maze->height - 1};
-
-    srand(time(NULL));
-
-	// remove all walls
-	for (size_t i = 0; i < maze->width * maze->height; i++) {
-		maze->cells[i].left = 0;
-		maze->cells[i].right = 0;
-		maze->cells[i].top = 0;
-		maze->cells[i].bottom = 0;
+		threads = online > 0 ? online : 1;
 	}
 
-	for (size_t i = 0; i < maze->width; i++) {
-		maze->cells[i].top = 1;
-		maze->cells[maze->width * (maze->height - 1) + i].bottom = 1;
+	if (!observer && threads > 1 &&
+	    maze->width * maze->height >= 2 * DIVIDE_TASK_CELLS) {
+		divideParallel(maze, &divideRng, threads);
+	} else {
+		recursive(maze, topLeft, bottomRight, &divideRng, NULL, observer);
 	}
 
-	for (size_t i = 0; i < maze->height; i++) {
-		maze->cells[maze->width * i].left = 1;
-		maze->cells[maze->width * i + maze->width - 1].right = 1;
-	}
+    // assign start and stop location
+    assignRandomStartAndStopObserved(maze, rng, observer);
 
-	fprintStep(stream, maze);
+    // write the finished maze
+    observeDone(observer, maze);
+}
 
-	recursiveSteps(maze, topLeft, bottomRight, stream);
+void recursiveDivisionGen(Maze_t *maze, MazeRng_t *rng) {
+	generate(maze, rng, 0, NULL);
+}
 
-    // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
+void recursiveDivisionGenThreads(Maze_t *maze, MazeRng_t *rng,
+                                 size_t threads) {
+	generate(maze, rng, threads ? threads : 1, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void recursiveDivisionGenObserved(Maze_t *maze, MazeRng_t *rng,
+                                  const StepObserver_t *observer) {
+	generate(maze, rng, 1, observer);
 }
@@ -0,0 +1,95 @@
+/**@file replay.c
+ * @brief The entry point for replaying binary step logs.
+ *
+ * This program turns a .mzd step log written by MazeSolver -v back into the
+ * text frames a plain -v run would have written.
+ *
+ * @author Blake Wingard (bats23456789@gmail.com)
+ * @bug No known bugs.
+ */
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stepSink.h"
+
+/**@brief Prints the help message for the program.
+ *
+ * @return void
+ */
+static void help(void) {
+    // clang-format off
+	puts("Usage:");
+	puts("  MazeReplay <log>                Writes the frames of <log> to stdout");
+	puts("  MazeReplay [options] <log>      Writes the frames of <log>");
+	puts("");
+	puts("Options:");
+	puts("  -o <file>, --output <file>      Write the frames to <file>");
+	puts("  -h, --help                      Print this message");
+    // clang-format on
+}
+
+int main(int argc, char *argv[]) {
+    int opt = 0;
+    int opts_index = 0;
+    FILE *inFile = NULL;
+    FILE *outFile = stdout;
+    bool valid;
+
+    // clang-format off
+	static struct option long_opts[] = {
+		{"help", no_argument, NULL, 'h'},
+		{"output", required_argument, NULL, 'o'},
+		{0, 0, 0, 0}
+	};
+    // clang-format on
+
+    while ((opt = getopt_long(argc, argv, "ho:", long_opts, &opts_index)) !=
+           -1) {
+        switch (opt) {
+            case 'h':
+                help();
+                return EXIT_SUCCESS;
+
+            case 'o':
+                outFile = fopen(optarg, "w");
+                if (!outFile) {
+                    fprintf(stderr, "ERROR opening \"%s\": %s\n", optarg,
+                            strerror(errno));
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            default:
+                help();
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        help();
+        return EXIT_FAILURE;
+    }
+
+    inFile = fopen(argv[optind], "rb");
+    if (!inFile) {
+        fprintf(stderr, "ERROR opening \"%s\": %s\n", argv[optind],
+                strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    valid = replayStepLog(inFile, outFile);
+    if (!valid) {
+        fprintf(stderr, "ERROR: \"%s\" is not a valid step log\n",
+                argv[optind]);
+    }
+
+    fclose(inFile);
+    if (outFile != stdout) {
+        fclose(outFile);
+    }
+
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,18 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 #include "MazeTools.h"
+#include "mazeBits.h"
 #include "sidewinder.h"
+#include "stepObserver.h"
 
-void sidewinderGen(Maze_t *maze) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     Point_t point = {0, 0};
     Point_t tmpPoint;
     size_t runSet[maze->width];
     size_t runCount = 0;
 
-    srand(time(NULL));
+	observeFrame(observer, maze, renderPlain);
 
     for (point.y = 0; point.y < maze->height; point.y++) {
         for (point.x = 0; point.x < maze->width; point.x++) {
@@ -21,71 +23,73 @@ void sidewinderGen(Maze_t *maze) {
             if (point.y == 0) {
                 if (point.x + 1 < maze->width) {
                     mazeBreakWall(maze, point, right);
+                    observeWall(observer, maze, point, right);
                 }
             } else if (point.x + 1 == maze->width) {
-                tmpPoint = indexToPoint(runSet[rand() % runCount], maze->width);
+                tmpPoint = indexToPoint(runSet[mazeRngBelow(rng, runCount)],
+                                        maze->width);
                 mazeBreakWall(maze, tmpPoint, up);
+                observeWall(observer, maze, tmpPoint, up);
 				runCount = 0;
             } else {
-				if (rand() % 2 == 0) {
+				if (mazeRngCoin(rng)) {
 					mazeBreakWall(maze, point, right);
+					observeWall(observer, maze, point, right);
 				} else {
-					tmpPoint = indexToPoint(runSet[rand() % runCount], maze->width);
+					tmpPoint = indexToPoint(
+						runSet[mazeRngBelow(rng, runCount)], maze->width);
 					mazeBreakWall(maze, tmpPoint, up);
+					observeWall(observer, maze, tmpPoint, up);
 					runCount = 0;
 				}
             }
+			observeFrame(observer, maze, renderPlain);
         }
         runCount = 0;
     }
 
     // assign start and stop location
-    assignRandomStartAndStop(maze);
+    assignRandomStartAndStopObserved(maze, rng, observer);
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    // write the finished maze
+    observeDone(observer, maze);
 }
 
-void sidewinderGenWithSteps(Maze_t *maze, FILE *restrict stream) {
-    Point_t point = {0, 0};
-    Point_t tmpPoint;
-    size_t runSet[maze->width];
-    size_t runCount = 0;
+void sidewinderGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    srand(time(NULL));
+void sidewinderGenObserved(Maze_t *maze, MazeRng_t *rng,
+                           const StepObserver_t *observer) {
+    generate(maze, rng, observer);
+}
 
-	fprintStep(stream, maze);
+void sidewinderGenBits(MazeBits_t *bits, MazeRng_t *rng) {
+    Point_t point = {0, 0};
+    Point_t tmpPoint;
+    uint32_t runStart = 0;
 
-    for (point.y = 0; point.y < maze->height; point.y++) {
-        for (point.x = 0; point.x < maze->width; point.x++) {
-            runSet[runCount++] = pointToIndex(point, maze->width);
+    for (point.y = 0; point.y < bits->height; point.y++) {
+        runStart = 0;
+        for (point.x = 0; point.x < bits->width; point.x++) {
             // for the top row, connect all horizontal cells
             if (point.y == 0) {
-                if (point.x + 1 < maze->width) {
-                    mazeBreakWall(maze, point, right);
+                if (point.x + 1 < bits->width) {
+                    mazeBitsBreakWall(bits, point, right);
                 }
-            } else if (point.x + 1 == maze->width) {
-                tmpPoint = indexToPoint(runSet[rand() % runCount], maze->width);
-                mazeBreakWall(maze, tmpPoint, up);
-				runCount = 0;
+            } else if (point.x + 1 == bits->width || !mazeRngCoin(rng)) {
+                // a run is always contiguous, so only its start is kept
+                tmpPoint.x =
+                    runStart + mazeRngBelow(rng, point.x - runStart + 1);
+                tmpPoint.y = point.y;
+                mazeBitsBreakWall(bits, tmpPoint, up);
+                runStart = point.x + 1;
             } else {
-				if (rand() % 2 == 0) {
-					mazeBreakWall(maze, point, right);
-				} else {
-					tmpPoint = indexToPoint(runSet[rand() % runCount], maze->width);
-					mazeBreakWall(maze, tmpPoint, up);
-					runCount = 0;
-				}
+                mazeBitsBreakWall(bits, point, right);
             }
-			fprintStep(stream, maze);
         }
-        runCount = 0;
     }
 
     // assign start and stop location
-    assignRandomStartAndStopWithSteps(maze, stream);
-
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+    assignRandomStartAndStopBits(bits, rng);
 }
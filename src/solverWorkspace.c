@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "solverWorkspace.h"
+
+static void *allocOrDie(size_t sz) {
+    void *ptr = malloc(sz);
+
+    if (ptr == NULL && sz != 0) {
+        perror("Failed to allocate workspace");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
+
+SolverWorkspace_t createSolverWorkspace(size_t sz) {
+    SolverWorkspace_t workspace;
+
+    workspace.sz = sz;
+    // epoch 0 is what a fresh stamp holds, so the first solve is epoch 1
+    workspace.epoch = 1;
+    workspace.stamps = calloc(sz ? sz : 1, sizeof(*workspace.stamps));
+    if (workspace.stamps == NULL) {
+        perror("Failed to allocate workspace");
+        exit(EXIT_FAILURE);
+    }
+    workspace.distance = allocOrDie(sizeof(*workspace.distance) * sz);
+    workspace.parents = createDirectionMap(sz);
+    workspace.ring = createRingQueue(64);
+    workspace.buckets = createBucketQueue(1);
+    workspace.heap = createIndexedHeap(sz);
+    workspace.stack = createDirectionStack(1024);
+
+    return workspace;
+}
+
+void resetSolverWorkspace(SolverWorkspace_t *workspace, size_t sz) {
+    if (sz > workspace->sz) {
+        freeSolverWorkspace(workspace);
+        *workspace = createSolverWorkspace(sz);
+        return;
+    }
+
+    if (++workspace->epoch == 0) {
+        // the tags wrapped, so old stamps could alias the new epoch
+        memset(workspace->stamps, 0, sizeof(*workspace->stamps) * workspace->sz);
+        workspace->epoch = 1;
+    }
+
+    clearRingQueue(&workspace->ring);
+    clearBucketQueue(&workspace->buckets);
+    clearIndexedHeap(&workspace->heap);
+    workspace->stack.count = 0;
+}
+
+void freeSolverWorkspace(SolverWorkspace_t *workspace) {
+    free(workspace->stamps);
+    free(workspace->distance);
+    freeDirectionMap(&workspace->parents);
+    freeRingQueue(&workspace->ring);
+    freeBucketQueue(&workspace->buckets);
+    freeIndexedHeap(&workspace->heap);
+    freeDirectionStack(&workspace->stack);
+    workspace->stamps = NULL;
+    workspace->distance = NULL;
+    workspace->sz = 0;
+}
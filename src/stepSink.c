@@ -0,0 +1,558 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "MazeTools.h"
+#include "mazeFile.h"
+#include "stepSink.h"
+
+// cells covered by one bit of the dirty map
+#define DIFF_CHUNK 64
+
+// the number of words in the dirty map of sz cells
+#define DIRTY_WORDS(sz) (((sz) + DIFF_CHUNK * 64 - 1) / (DIFF_CHUNK * 64))
+
+// A frame waiting for the writer thread.
+typedef struct {
+    char *data;
+    size_t sz;
+    size_t cap;
+} StepFrame_t;
+
+// The background writer of a sink. The producer fills the slot after the
+// last queued one and the writer drains from head, so neither touches a slot
+// the other owns and the lock is only held to move head and count.
+typedef struct StepWriter_t {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t space;
+    StepFrame_t *slots;
+    size_t depth;
+    size_t head;
+    size_t count;
+    bool done;
+    FILE *stream;
+} StepWriter_t;
+
+StepSink_t createStepSink(FILE *stream, stepFormat_t format) {
+    StepSink_t sink;
+
+    sink.stream = stream;
+    sink.format = format;
+    sink.shadow = NULL;
+    sink.sz = 0;
+    sink.dirty = NULL;
+    sink.text = NULL;
+    sink.textSz = 0;
+    sink.textFlags = renderPlain;
+    sink.buf = NULL;
+    sink.bufSz = 0;
+    sink.bufCap = 0;
+    sink.writer = NULL;
+    sink.every = 1;
+    sink.skipped = 0;
+    sink.interval = 0;
+    sink.next = 0;
+
+    return sink;
+}
+
+void setStepSinkRate(StepSink_t *sink, uint64_t every, double fps) {
+    sink->every = every ? every : 1;
+    // the first step shows where the algorithm started
+    sink->skipped = sink->every - 1;
+    sink->interval = fps > 0 ? 1 / fps : 0;
+    sink->next = 0;
+}
+
+static void *stepWriterMain(void *arg) {
+    StepWriter_t *writer = arg;
+    StepFrame_t *frame;
+
+    pthread_mutex_lock(&writer->lock);
+    for (;;) {
+        while (writer->count == 0 && !writer->done) {
+            pthread_cond_wait(&writer->ready, &writer->lock);
+        }
+        if (writer->count == 0) {
+            break;
+        }
+        frame = &writer->slots[writer->head];
+        pthread_mutex_unlock(&writer->lock);
+
+        fwrite(frame->data, 1, frame->sz, writer->stream);
+
+        pthread_mutex_lock(&writer->lock);
+        writer->head = (writer->head + 1) % writer->depth;
+        writer->count--;
+        pthread_cond_signal(&writer->space);
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    return NULL;
+}
+
+void startStepSinkWriter(StepSink_t *sink, size_t depth) {
+    StepWriter_t *writer;
+
+    if (sink->writer) {
+        return;
+    }
+
+    writer = malloc(sizeof(*writer));
+    if (writer == NULL) {
+        perror("Failed to allocate step writer");
+        exit(EXIT_FAILURE);
+    }
+
+    writer->depth = depth ? depth : 1;
+    writer->slots = calloc(writer->depth, sizeof(*writer->slots));
+    if (writer->slots == NULL) {
+        perror("Failed to allocate step writer");
+        exit(EXIT_FAILURE);
+    }
+    writer->head = 0;
+    writer->count = 0;
+    writer->done = false;
+    writer->stream = sink->stream;
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->ready, NULL);
+    pthread_cond_init(&writer->space, NULL);
+
+    if (pthread_create(&writer->thread, NULL, stepWriterMain, writer) != 0) {
+        perror("Failed to start step writer");
+        exit(EXIT_FAILURE);
+    }
+
+    sink->writer = writer;
+}
+
+// Waits for every queued frame to be written and stops the writer thread.
+static void stopStepWriter(StepWriter_t *writer) {
+    pthread_mutex_lock(&writer->lock);
+    writer->done = true;
+    pthread_cond_signal(&writer->ready);
+    pthread_mutex_unlock(&writer->lock);
+
+    pthread_join(writer->thread, NULL);
+
+    for (size_t i = 0; i < writer->depth; i++) {
+        free(writer->slots[i].data);
+    }
+    free(writer->slots);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->ready);
+    pthread_cond_destroy(&writer->space);
+    free(writer);
+}
+
+// Writes a frame given in two parts, or hands it to the writer thread.
+static void emitFrame(StepSink_t *sink, const void *head, size_t headSz,
+                      const void *body, size_t bodySz) {
+    StepWriter_t *writer = sink->writer;
+    StepFrame_t *frame;
+
+    if (writer == NULL) {
+        fwrite(head, 1, headSz, sink->stream);
+        if (bodySz) {
+            fwrite(body, 1, bodySz, sink->stream);
+        }
+        return;
+    }
+
+    // backpressure: wait for the writer to free a slot
+    pthread_mutex_lock(&writer->lock);
+    while (writer->count == writer->depth) {
+        pthread_cond_wait(&writer->space, &writer->lock);
+    }
+    frame = &writer->slots[(writer->head + writer->count) % writer->depth];
+    pthread_mutex_unlock(&writer->lock);
+
+    if (frame->cap < headSz + bodySz) {
+        free(frame->data);
+        frame->cap = headSz + bodySz;
+        frame->data = malloc(frame->cap);
+        if (frame->data == NULL) {
+            perror("Failed to allocate step frame");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(frame->data, head, headSz);
+    if (bodySz) {
+        memcpy(frame->data + headSz, body, bodySz);
+    }
+    frame->sz = headSz + bodySz;
+
+    pthread_mutex_lock(&writer->lock);
+    writer->count++;
+    pthread_cond_signal(&writer->ready);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+void freeStepSink(StepSink_t *sink) {
+    if (sink->writer) {
+        stopStepWriter(sink->writer);
+        sink->writer = NULL;
+    }
+    free(sink->shadow);
+    free(sink->dirty);
+    free(sink->text);
+    free(sink->buf);
+    sink->shadow = NULL;
+    sink->sz = 0;
+    sink->dirty = NULL;
+    sink->text = NULL;
+    sink->textSz = 0;
+    sink->buf = NULL;
+    sink->bufSz = 0;
+    sink->bufCap = 0;
+}
+
+bool isStepLogPath(const char *path) {
+    size_t len = strlen(path);
+
+    return len >= 4 && strcmp(path + len - 4, ".mzd") == 0;
+}
+
+uint16_t cellToFlags(Cell_t cell) {
+    return (cell.queued ? CELL_FLAG_QUEUED : 0) |
+           (cell.observing ? CELL_FLAG_OBSERVING : 0) |
+           (cell.path ? CELL_FLAG_PATH : 0) |
+           (cell.start ? CELL_FLAG_START : 0) |
+           (cell.stop ? CELL_FLAG_STOP : 0) |
+           (cell.visited ? CELL_FLAG_VISITED : 0) |
+           (cell.top ? CELL_FLAG_TOP : 0) |
+           (cell.bottom ? CELL_FLAG_BOTTOM : 0) |
+           (cell.left ? CELL_FLAG_LEFT : 0) |
+           (cell.right ? CELL_FLAG_RIGHT : 0);
+}
+
+Cell_t flagsToCell(uint16_t flags) {
+    Cell_t cell = {0};
+
+    cell.queued = (flags & CELL_FLAG_QUEUED) != 0;
+    cell.observing = (flags & CELL_FLAG_OBSERVING) != 0;
+    cell.path = (flags & CELL_FLAG_PATH) != 0;
+    cell.start = (flags & CELL_FLAG_START) != 0;
+    cell.stop = (flags & CELL_FLAG_STOP) != 0;
+    cell.visited = (flags & CELL_FLAG_VISITED) != 0;
+    cell.top = (flags & CELL_FLAG_TOP) != 0;
+    cell.bottom = (flags & CELL_FLAG_BOTTOM) != 0;
+    cell.left = (flags & CELL_FLAG_LEFT) != 0;
+    cell.right = (flags & CELL_FLAG_RIGHT) != 0;
+
+    return cell;
+}
+
+static size_t encodeVarint(uint8_t *out, uint64_t val) {
+    size_t sz = 0;
+
+    while (val >= 0x80) {
+        out[sz++] = (uint8_t)(val | 0x80);
+        val >>= 7;
+    }
+    out[sz++] = (uint8_t)val;
+
+    return sz;
+}
+
+// Appends a varint to the frame being encoded.
+static void bufVarint(StepSink_t *sink, uint64_t val) {
+    // a 64-bit varint never needs more than 10 bytes
+    if (sink->bufSz + 10 > sink->bufCap) {
+        sink->bufCap = sink->bufCap ? sink->bufCap * 2 : 4096;
+        sink->buf = realloc(sink->buf, sink->bufCap);
+        if (sink->buf == NULL) {
+            perror("Failed to allocate step buffer");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sink->bufSz += encodeVarint(sink->buf + sink->bufSz, val);
+}
+
+static bool readVarint(FILE *stream, uint64_t *val) {
+    int c;
+
+    *val = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        c = getc(stream);
+        if (c == EOF) {
+            return false;
+        }
+        *val |= (uint64_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static double monotonicSeconds(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Determines if the current step should be written as a frame.
+static bool stepDue(StepSink_t *sink) {
+    double now;
+
+    if (++sink->skipped < sink->every) {
+        return false;
+    }
+
+    if (sink->interval > 0) {
+        now = monotonicSeconds();
+        if (now < sink->next) {
+            return false;
+        }
+        sink->next = now + sink->interval;
+    }
+
+    sink->skipped = 0;
+
+    return true;
+}
+
+static void allocShadow(StepSink_t *sink, size_t sz) {
+    sink->shadow = calloc(sz ? sz : 1, sizeof(*sink->shadow));
+    sink->dirty = calloc(DIRTY_WORDS(sz) + 1, sizeof(*sink->dirty));
+    if (sink->shadow == NULL || sink->dirty == NULL) {
+        perror("Failed to allocate step shadow");
+        exit(EXIT_FAILURE);
+    }
+    sink->sz = sz;
+}
+
+// Calls changed for every cell in a dirty chunk whose flags differ from the
+// shadow, then brings the shadow up to date and clears the dirty map.
+static void diffCells(StepSink_t *sink, const Maze_t *maze,
+                      void (*changed)(StepSink_t *, const Maze_t *, size_t,
+                                      uint16_t)) {
+    for (size_t word = 0; word < DIRTY_WORDS(sink->sz); word++) {
+        uint64_t bits = sink->dirty[word];
+
+        // most of a maze is untouched between two steps
+        if (bits == 0) {
+            continue;
+        }
+        sink->dirty[word] = 0;
+
+        for (size_t bit = 0; bits; bit++, bits >>= 1) {
+            size_t chunk = (word * 64 + bit) * DIFF_CHUNK;
+            size_t end;
+
+            // the first delta frame marks past the end of the maze
+            if (!(bits & 1) || chunk >= sink->sz) {
+                continue;
+            }
+
+            end = chunk + DIFF_CHUNK < sink->sz ? chunk + DIFF_CHUNK : sink->sz;
+            for (size_t i = chunk; i < end; i++) {
+                uint16_t mask =
+                    cellToFlags(sink->shadow[i]) ^ cellToFlags(maze->cells[i]);
+
+                if (mask) {
+                    changed(sink, maze, i, mask);
+                }
+            }
+            memcpy(sink->shadow + chunk, maze->cells + chunk,
+                   sizeof(*maze->cells) * (end - chunk));
+        }
+    }
+}
+
+static void encodeChange(StepSink_t *sink, const Maze_t *maze, size_t i,
+                         uint16_t mask) {
+    bufVarint(sink, i - sink->last);
+    bufVarint(sink, mask);
+    sink->last = i;
+    sink->changes++;
+}
+
+// Writes the cells that changed since the last frame.
+static void writeDelta(StepSink_t *sink, Maze_t *maze, uint8_t frame) {
+    uint8_t head[1 + 10];
+    size_t headSz;
+
+    if (sink->shadow == NULL) {
+        StepLogHeader_t header;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, STEP_LOG_MAGIC, sizeof(header.magic));
+        header.byteOrder = MAZE_FILE_BYTE_ORDER;
+        header.width = maze->width;
+        header.height = maze->height;
+        emitFrame(sink, &header, sizeof(header), NULL, 0);
+
+        // the first frame is the difference from a maze without any flags
+        allocShadow(sink, maze->width * maze->height);
+        memset(sink->dirty, 0xff, sizeof(*sink->dirty) * DIRTY_WORDS(sink->sz));
+    }
+
+    sink->bufSz = 0;
+    sink->last = 0;
+    sink->changes = 0;
+    diffCells(sink, maze, encodeChange);
+
+    head[0] = frame;
+    headSz = 1 + encodeVarint(head + 1, sink->changes);
+    emitFrame(sink, head, headSz, sink->buf, sink->bufSz);
+}
+
+static void patchChange(StepSink_t *sink, const Maze_t *maze, size_t i,
+                        uint16_t mask) {
+    patchMazeString(maze, sink->text, i, sink->textFlags);
+}
+
+// Brings the held text frame up to date and writes it.
+static void writeText(StepSink_t *sink, Maze_t *maze, renderFlags_t flags,
+                      bool final) {
+    if (sink->text == NULL || sink->textFlags != flags) {
+        // redraw everything when there is no frame to patch
+        if (sink->text == NULL) {
+            sink->textSz = renderMaze(maze, NULL, 0, flags);
+            sink->text = malloc(sizeof(*sink->text) * sink->textSz);
+            if (sink->text == NULL) {
+                perror("Failed to allocate step frame");
+                exit(EXIT_FAILURE);
+            }
+        }
+        renderMaze(maze, sink->text, sink->textSz, flags);
+        sink->textFlags = flags;
+
+        if (sink->shadow == NULL) {
+            allocShadow(sink, maze->width * maze->height);
+        }
+        memcpy(sink->shadow, maze->cells, sizeof(*sink->shadow) * sink->sz);
+        memset(sink->dirty, 0, sizeof(*sink->dirty) * DIRTY_WORDS(sink->sz));
+    } else {
+        diffCells(sink, maze, patchChange);
+    }
+
+    // every frame but the last is followed by a blank line
+    emitFrame(sink, sink->text, sink->textSz - 1, "\n", final ? 0 : 1);
+
+    if (final) {
+        invalidateMazeString(maze);
+        maze->str = sink->text;
+        sink->text = NULL;
+    }
+}
+
+// Marks the chunk of a changed cell for the next frame to diff. Changes
+// before the first frame need no mark, as that frame looks at every cell.
+static void sinkCellChanged(void *ctx, const Maze_t *maze, size_t index) {
+    StepSink_t *sink = ctx;
+    size_t chunk = index / DIFF_CHUNK;
+
+    if (sink->dirty) {
+        sink->dirty[chunk / 64] |= (uint64_t)1 << (chunk % 64);
+    }
+}
+
+static void sinkFrame(void *ctx, Maze_t *maze, renderFlags_t flags) {
+    StepSink_t *sink = ctx;
+
+    if (!stepDue(sink)) {
+        return;
+    }
+
+    if (sink->format == deltaSteps) {
+        writeDelta(sink, maze,
+                   flags & renderIgnoreVisited ? STEP_FRAME_IGNORE_VISITED : 0);
+    } else {
+        writeText(sink, maze, flags, false);
+    }
+}
+
+static void sinkDone(void *ctx, Maze_t *maze) {
+    StepSink_t *sink = ctx;
+
+    if (sink->format == deltaSteps) {
+        writeDelta(sink, maze, STEP_FRAME_FINAL);
+    } else {
+        writeText(sink, maze, renderPlain, true);
+    }
+}
+
+StepObserver_t stepSinkObserver(StepSink_t *sink) {
+    StepObserver_t observer;
+
+    observer.ctx = sink;
+    observer.cellChanged = sinkCellChanged;
+    observer.frame = sinkFrame;
+    observer.done = sinkDone;
+
+    return observer;
+}
+
+bool replayStepLog(FILE *in, FILE *out) {
+    StepLogHeader_t header;
+    StepSink_t sink;
+    StepObserver_t observer;
+    Maze_t maze;
+    size_t sz;
+    int frame;
+    bool valid = true;
+
+    if (fread(&header, sizeof(header), 1, in) != 1) {
+        // nothing was ever written
+        return feof(in) && !ferror(in);
+    }
+
+    if (memcmp(header.magic, STEP_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.byteOrder != MAZE_FILE_BYTE_ORDER) {
+        return false;
+    }
+
+    maze = createMazeWH(header.width, header.height);
+    sz = maze.width * maze.height;
+    for (size_t i = 0; i < sz; i++) {
+        maze.cells[i] = flagsToCell(0);
+    }
+
+    // the frames are redrawn as incrementally as they were recorded
+    sink = createStepSink(out, textSteps);
+    observer = stepSinkObserver(&sink);
+
+    while (valid && (frame = getc(in)) != EOF) {
+        uint64_t count, gap, mask;
+        size_t i = 0;
+
+        valid = readVarint(in, &count);
+        for (uint64_t change = 0; valid && change < count; change++) {
+            valid = readVarint(in, &gap) && readVarint(in, &mask) &&
+                    gap < sz - i && mask <= UINT16_MAX;
+            if (valid) {
+                i += gap;
+                maze.cells[i] =
+                    flagsToCell(cellToFlags(maze.cells[i]) ^ (uint16_t)mask);
+                observeCell(&observer, &maze, i);
+            }
+        }
+
+        if (!valid) {
+            break;
+        }
+
+        if (frame & STEP_FRAME_IGNORE_VISITED) {
+            observeFrame(&observer, &maze, renderIgnoreVisited);
+        } else if (frame & STEP_FRAME_FINAL) {
+            observeDone(&observer, &maze);
+        } else {
+            observeFrame(&observer, &maze, renderPlain);
+        }
+    }
+
+    freeStepSink(&sink);
+    freeMaze(maze);
+
+    return valid && !ferror(in);
+}
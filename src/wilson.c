@@ -1,155 +1,191 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "MazeTools.h"
-
-static Point_t getRandomUnvistedPoint(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t unvistedIndexes[sz];
-    size_t unvistedSz = 0;
+#include "wilson.h"
+#include "stepObserver.h"
+
+// The cells not yet in the maze. A cell is removed by moving the last cell
+// into its place, so drawing and removing one are both O(1).
+typedef struct {
+    uint32_t *cells;
+    uint32_t *slots;
+    size_t count;
+} UnvisitedSet_t;
+
+static UnvisitedSet_t createUnvisitedSet(size_t sz) {
+    UnvisitedSet_t set = {.cells = NULL, .slots = NULL, .count = sz};
+
+    set.cells = malloc(sizeof(*set.cells) * (sz ? sz : 1));
+    set.slots = malloc(sizeof(*set.slots) * (sz ? sz : 1));
+    if (set.cells == NULL || set.slots == NULL) {
+        perror("Failed to allocate unvisited cells");
+        exit(EXIT_FAILURE);
+    }
 
     for (size_t i = 0; i < sz; i++) {
-        if (maze->cells[i].visited == 0) {
-            unvistedIndexes[unvistedSz++] = i;
-        }
+        set.cells[i] = i;
+        set.slots[i] = i;
     }
 
-    return indexToPoint(unvistedIndexes[rand() % unvistedSz], maze->width);
+    return set;
 }
 
-void wilsonGen(Maze_t *maze) {
-    size_t sz = maze->width * maze->height;
-    size_t unvistedCellCount = sz;
-    size_t i;
-    Point_t point, startPoint;
-    Direction_t travelVectors[sz];
-    Direction_t dir;
-
-    srand(time(NULL));
-
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
-
-    maze->cells[pointToIndex(point, maze->width)].visited = 1;
-    unvistedCellCount--;
-
-    while (unvistedCellCount > 0) {
-        startPoint = point = getRandomUnvistedPoint(maze);
-
-        i = pointToIndex(point, maze->width);
-        maze->cells[i].queued = 1;
-        while (maze->cells[i].visited == 0) {
-            dir = getRandomDirection(point, *maze);
-            travelVectors[i] = dir;
-            point = pointShift(point, dir);
-            i = pointToIndex(point, maze->width);
-            maze->cells[i].queued = 1;
-        }
-
-        while (startPoint.x != point.x || startPoint.y != point.y) {
-            i = pointToIndex(startPoint, maze->width);
-            Point_t newPoint = pointShift(startPoint, travelVectors[i]);
-			mazeBreakWall(maze, startPoint, travelVectors[i]);
-			startPoint = newPoint;
-			maze->cells[i].queued = 0;
-			maze->cells[i].visited = 1;
-			unvistedCellCount--;
-        }
-
-        for (size_t i = 0; i < sz; i++) {
-            maze->cells[i].queued = 0;
-        }
-    }
-
-    for (size_t i = 0; i < sz; i++) {
-        maze->cells[i].visited = 0;
-    }
+static void freeUnvisitedSet(UnvisitedSet_t *set) {
+    free(set->cells);
+    free(set->slots);
+    set->cells = NULL;
+    set->slots = NULL;
+    set->count = 0;
+}
 
-    // assign start and stop location
-	assignRandomStartAndStop(maze);
+static void removeUnvisited(UnvisitedSet_t *set, uint32_t i) {
+    uint32_t last = set->cells[--set->count];
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
+    set->cells[set->slots[i]] = last;
+    set->slots[last] = set->slots[i];
 }
 
-void wilsonGenWithSteps(Maze_t *maze, FILE *restrict stream) {
+OBSERVED_INLINE void generate(Maze_t *maze, MazeRng_t *rng,
+                              const StepObserver_t *observer) {
     size_t sz = maze->width * maze->height;
-    size_t unvistedCellCount = sz;
+    UnvisitedSet_t unvisited = createUnvisitedSet(sz);
+    uint8_t *travelVectors = malloc(sizeof(*travelVectors) * (sz ? sz : 1));
+    uint32_t *walked = NULL;
+    size_t walkedSz = 0;
     size_t i;
     Point_t point, startPoint;
-    Direction_t travelVectors[sz];
     Direction_t dir;
 
-    srand(time(NULL));
+    if (travelVectors == NULL) {
+        perror("Failed to allocate Wilson walk");
+        exit(EXIT_FAILURE);
+    }
 
-	fprintStepIgnoreVisted(stream, maze);
+    // the cells marked by a walk, so only they are cleared after it
+    if (observer) {
+        walked = malloc(sizeof(*walked) * (sz ? sz : 1));
+        if (walked == NULL) {
+            perror("Failed to allocate Wilson walk");
+            exit(EXIT_FAILURE);
+        }
+    }
 
-    point.x = rand() % maze->width;
-    point.y = rand() % maze->height;
+    observeFrame(observer, maze, renderIgnoreVisited);
 
-    maze->cells[pointToIndex(point, maze->width)].visited = 1;
-    maze->cells[pointToIndex(point, maze->width)].observing = 1;
-    unvistedCellCount--;
+    point.x = mazeRngBelow(rng, maze->width);
+    point.y = mazeRngBelow(rng, maze->height);
 
-	fprintStepIgnoreVisted(stream, maze);
+    i = pointToIndex(point, maze->width);
+    maze->cells[i].visited = 1;
+    if (observer) {
+        maze->cells[i].observing = 1;
+        observeCell(observer, maze, i);
+        observeFrame(observer, maze, renderIgnoreVisited);
+    }
+    removeUnvisited(&unvisited, i);
 
-    while (unvistedCellCount > 0) {
-        startPoint = point = getRandomUnvistedPoint(maze);
+    while (unvisited.count > 0) {
+        i = unvisited.cells[mazeRngBelow(rng, unvisited.count)];
+        startPoint = point = indexToPoint(i, maze->width);
 
-        i = pointToIndex(point, maze->width);
-        maze->cells[i].queued = 1;
-		maze->cells[i].observing = 1;
-		fprintStepIgnoreVisted(stream, maze);
+        if (observer) {
+            // the walk is only marked to be drawn
+            maze->cells[i].queued = 1;
+            maze->cells[i].observing = 1;
+            walked[walkedSz++] = i;
+            observeCell(observer, maze, i);
+            observeFrame(observer, maze, renderIgnoreVisited);
+        }
 
         while (maze->cells[i].visited == 0) {
-			maze->cells[i].observing = 0;
+            if (observer) {
+                maze->cells[i].observing = 0;
+                observeCell(observer, maze, i);
+            }
 
-            dir = getRandomDirection(point, *maze);
+            dir = getRandomDirection(point, *maze, rng);
             travelVectors[i] = dir;
             point = pointShift(point, dir);
             i = pointToIndex(point, maze->width);
 
-            maze->cells[i].queued = 1;
-            maze->cells[i].observing = 1;
-			fprintStepIgnoreVisted(stream, maze);
+            if (observer) {
+                if (!maze->cells[i].queued) {
+                    walked[walkedSz++] = i;
+                }
+                maze->cells[i].queued = 1;
+                maze->cells[i].observing = 1;
+                observeCell(observer, maze, i);
+                observeFrame(observer, maze, renderIgnoreVisited);
+            }
         }
 
-		maze->cells[pointToIndex(startPoint, maze->width)].observing = 1;
-		fprintStepIgnoreVisted(stream, maze);
+        if (observer) {
+            i = pointToIndex(startPoint, maze->width);
+            maze->cells[i].observing = 1;
+            observeCell(observer, maze, i);
+            observeFrame(observer, maze, renderIgnoreVisited);
+        }
 
         while (startPoint.x != point.x || startPoint.y != point.y) {
             i = pointToIndex(startPoint, maze->width);
-			maze->cells[i].observing = 0;
-
-            Point_t newPoint = pointShift(startPoint, travelVectors[i]);
-			size_t newI = pointToIndex(newPoint, maze->width);
-
-			mazeBreakWall(maze, startPoint, travelVectors[i]);
-			startPoint = newPoint;
-			maze->cells[i].queued = 0;
-			maze->cells[i].visited = 1;
-			maze->cells[newI].observing = 1;
-			unvistedCellCount--;
-			fprintStepIgnoreVisted(stream, maze);
+            dir = travelVectors[i];
+            Point_t newPoint = pointShift(startPoint, dir);
+            size_t newI = pointToIndex(newPoint, maze->width);
+
+            mazeBreakWall(maze, startPoint, dir);
+            startPoint = newPoint;
+            maze->cells[i].visited = 1;
+            removeUnvisited(&unvisited, i);
+            if (observer) {
+                maze->cells[i].observing = 0;
+                maze->cells[i].queued = 0;
+                maze->cells[newI].observing = 1;
+                observeCell(observer, maze, i);
+                observeCell(observer, maze, newI);
+                observeFrame(observer, maze, renderIgnoreVisited);
+            }
         }
 
-		maze->cells[pointToIndex(point, maze->width)].observing = 0;
-
-        for (size_t i = 0; i < sz; i++) {
-            maze->cells[i].queued = 0;
+        if (observer) {
+            i = pointToIndex(point, maze->width);
+            maze->cells[i].observing = 0;
+            observeCell(observer, maze, i);
+
+            // cells erased from the walk are still marked
+            for (size_t j = 0; j < walkedSz; j++) {
+                if (maze->cells[walked[j]].queued) {
+                    maze->cells[walked[j]].queued = 0;
+                    observeCell(observer, maze, walked[j]);
+                }
+            }
+            walkedSz = 0;
+            observeFrame(observer, maze, renderIgnoreVisited);
         }
-		fprintStepIgnoreVisted(stream, maze);
     }
 
+    freeUnvisitedSet(&unvisited);
+    free(travelVectors);
+    free(walked);
+
     for (size_t i = 0; i < sz; i++) {
         maze->cells[i].visited = 0;
+        observeCell(observer, maze, i);
     }
 
     // assign start and stop location
-	assignRandomStartAndStopWithSteps(maze, stream);
+    assignRandomStartAndStopObserved(maze, rng, observer);
+
+    // write the finished maze
+    observeDone(observer, maze);
+}
+
+void wilsonGen(Maze_t *maze, MazeRng_t *rng) {
+    generate(maze, rng, NULL);
+}
 
-    // stringify
-    maze->str = graphToString(maze->cells, maze->width, maze->height);
-    fputs(maze->str, stream);
+void wilsonGenObserved(Maze_t *maze, MazeRng_t *rng,
+                       const StepObserver_t *observer) {
+    generate(maze, rng, observer);
 }